@@ -1,8 +1,8 @@
 #ifndef CCTOP_CCTOP_H
 #define CCTOP_CCTOP_H
 
-#define USE_NCURSES
-//#undef USE_NCURSES
+// USE_NCURSES comes from the build; cmake -DUSE_NCURSES=OFF uses Console's
+// own ANSI backend instead and doesn't need libncursesw.
 
 // define VERBOSE to enable debug printing
 #define VERBOSE
@@ -17,9 +17,23 @@
 
 #include "common/Debug.h"
 
+#include "lib/Clock.h"
 #include "lib/Console.h"
+#include "lib/EventLoop.h"
+#include "lib/History.h"
 #include "lib/Options.h"
 #include "lib/Help.h"
+#include "lib/Layout.h"
+#include "lib/Snapshot.h"
+#include "lib/Recording.h"
+#include "lib/MetricsServer.h"
+#include "lib/PushExporter.h"
+#include "lib/SharedSnapshot.h"
+#include "lib/SharedPublisher.h"
+#include "lib/Socket.h"
+#include "lib/FrameStream.h"
+#include "lib/ViewerServer.h"
+#include "lib/Alerts.h"
 
 #include "macos/Platform.h"
 #include "macos/CPU.h"
@@ -29,6 +43,15 @@
 #include "macos/ProcessList.h"
 #include "macos/Battery.h"
 
+#include "common/Sensors.h"
+#include "common/Interrupts.h"
+#include "common/SchedStat.h"
+#include "common/Filesystem.h"
+#include "common/Graphs.h"
+#include "common/ProcessFilter.h"
+#include "common/Replay.h"
+#include "common/Fleet.h"
+
 const int MIN_WIDTH = 96, MIN_HEIGHT = 30;
 
 #endif //CCTOP_CCTOP_H
@@ -0,0 +1,494 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Filesystem.h"
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+
+#ifdef __APPLE__
+#include <sys/event.h>
+#include <sys/mount.h>
+#include <sys/param.h>
+#endif
+
+// pseudo and container filesystems that would only clutter the panel
+static const char *ignored_types[] = {
+        "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+        "devfs", "devpts", "devtmpfs", "efivarfs", "fusectl", "hugetlbfs", "mqueue",
+        "nsfs", "nullfs", "proc", "pstore", "rpc_pipefs", "securityfs",
+        "selinuxfs", "squashfs", "sysfs", "tmpfs", "tracefs",
+        nullptr,
+};
+
+// filesystems whose statvfs() can hang when the server goes away
+static const char *network_types[] = {
+        "9p", "afpfs", "ceph", "cifs", "fuse.sshfs", "glusterfs", "lustre", "nfs",
+        "nfs4", "smb3", "smbfs", "webdav",
+        nullptr,
+};
+
+static bool in_list(const char **list, const std::string &type) {
+    for (const char **p = list; *p; p++) {
+        if (type == *p) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int64_t now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Mount::set(const struct statvfs &st) {
+    uint64_t frsize = st.f_frsize ? st.f_frsize : st.f_bsize;
+    size = uint64_t(st.f_blocks) * frsize;
+    used = size - uint64_t(st.f_bfree) * frsize;
+    avail = uint64_t(st.f_bavail) * frsize;
+    inodes = st.f_files;
+    inodes_free = st.f_ffree;
+    valid = true;
+    hung = false;
+}
+
+#ifndef __APPLE__
+// major:minor of every filesystem mounted whole (root "/") somewhere in mountinfo
+static std::unordered_set<std::string> whole_devices(const char *text) {
+    std::unordered_set<std::string> devices;
+    for (const char *line = text; *line;) {
+        const char *eol = strchr(line, '\n');
+        if (!eol) {
+            eol = line + strlen(line);
+        }
+        // id parent major:minor root
+        const char *p = line, *device = nullptr, *device_end = nullptr;
+        for (int nf = 0; nf < 4 && p < eol; nf++) {
+            const char *end = (const char *) memchr(p, ' ', eol - p);
+            if (!end) {
+                end = eol;
+            }
+            if (nf == 2) {
+                device = p;
+                device_end = end;
+            } else if (nf == 3 && device && end - p == 1 && *p == '/') {
+                devices.emplace(device, device_end - device);
+            }
+            p = end + 1;
+        }
+        line = *eol ? eol + 1 : eol;
+    }
+    return devices;
+}
+
+// mountinfo escapes blanks, tabs, newlines and backslashes as \ooo
+static std::string unescape(const char *s, size_t len) {
+    std::string out;
+    out.reserve(len);
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\\' && i + 3 < len && s[i + 1] >= '0' && s[i + 1] <= '3') {
+            out += char((s[i + 1] - '0') * 64 + (s[i + 2] - '0') * 8 + (s[i + 3] - '0'));
+            i += 3;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+// whole disk name for a major:minor, as the disk panel names it (sda for
+// sda1, nvme0n1 for nvme0n1p2, dm-0 for an LVM volume)
+static std::string disk_name(const char *major_minor) {
+    char path[PATH_MAX], resolved[PATH_MAX];
+    snprintf(path, sizeof(path), "/sys/dev/block/%s", major_minor);
+    if (!realpath(path, resolved)) {
+        return "";
+    }
+    std::string dev(resolved);
+    std::string partition = dev + "/partition";
+    if (SysFile::exists(partition.c_str())) {
+        dev = dev.substr(0, dev.rfind('/'));
+    }
+    return dev.substr(dev.rfind('/') + 1);
+}
+#else
+// /dev/disk3s1s1 is a slice of disk3
+static std::string disk_name(const char *device) {
+    if (strncmp(device, "/dev/disk", 9) != 0) {
+        return "";
+    }
+    const char *p = &device[9];
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    return std::string(&device[5], p - &device[5]);
+}
+#endif
+
+Filesystem::Filesystem() {
+#ifdef __APPLE__
+    changes_fd = kqueue();
+    if (changes_fd >= 0) {
+        struct kevent ev{};
+        EV_SET(&ev, 0, EVFILT_FS, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+        kevent(changes_fd, &ev, 1, nullptr, 0, nullptr);
+    }
+#else
+    mountinfo = new SysFile("/proc/self/mountinfo");
+    changes_fd = mountinfo->descriptor();
+#endif
+    update();
+}
+
+Filesystem::~Filesystem() {
+    for (auto *m: mounts) {
+        delete m;
+    }
+    mounts.clear();
+#ifdef __APPLE__
+    if (changes_fd >= 0) {
+        close(changes_fd);
+    }
+#endif
+    delete mountinfo;
+    mountinfo = nullptr;
+}
+
+bool Filesystem::changed() {
+    if (changes_fd < 0) {
+        return true;
+    }
+#ifdef __APPLE__
+    pollfd p{changes_fd, POLLIN, 0};
+    if (poll(&p, 1, 0) <= 0) {
+        return false;
+    }
+    // drain the mount/unmount events
+    struct kevent events[8];
+    timespec zero{0, 0};
+    while (kevent(changes_fd, nullptr, 0, events, 8, &zero) > 0) {
+    }
+    return true;
+#else
+    // the kernel flags POLLPRI|POLLERR on mountinfo once per change
+    pollfd p{changes_fd, POLLPRI, 0};
+    return poll(&p, 1, 0) > 0 && (p.revents & (POLLPRI | POLLERR));
+#endif
+}
+
+void Filesystem::changes_ready() {
+    // drains the kqueue on MacOS; on Linux the wakeup itself consumed the event
+    changed();
+    dirty = true;
+}
+
+Mount *Filesystem::find(const std::string &path, const std::string &device) {
+    for (auto *m: mounts) {
+        if (m->path == path && m->device == device) {
+            return m;
+        }
+    }
+    return nullptr;
+}
+
+void Filesystem::read_mounts() {
+    for (auto *m: mounts) {
+        m->seen = false;
+    }
+    std::vector<Mount *> list;
+
+#ifdef __APPLE__
+    int n = getfsstat(nullptr, 0, MNT_NOWAIT);
+    if (n <= 0) {
+        return;
+    }
+    std::vector<struct statfs> fs(n);
+    n = getfsstat(fs.data(), int(n * sizeof(struct statfs)), MNT_NOWAIT);
+    for (int i = 0; i < n; i++) {
+        std::string type(fs[i].f_fstypename), path(fs[i].f_mntonname), device(fs[i].f_mntfromname);
+        if (in_list(ignored_types, type) || (fs[i].f_flags & MNT_DONTBROWSE)) {
+            continue;
+        }
+        Mount *m = find(path, device);
+        if (!m) {
+            m = new Mount;
+            m->path = path;
+            m->device = device;
+            m->type = type;
+            m->network = in_list(network_types, type) || !(fs[i].f_flags & MNT_LOCAL);
+            m->disk = disk_name(device.c_str());
+        }
+        m->seen = true;
+        list.push_back(m);
+    }
+#else
+    const char *text = mountinfo->read();
+    if (!text) {
+        return;
+    }
+    std::unordered_set<std::string> whole = whole_devices(text);
+    // id parent major:minor root mountpoint options [optional...] - type source superoptions
+    for (const char *line = text; *line;) {
+        const char *eol = strchr(line, '\n');
+        if (!eol) {
+            eol = line + strlen(line);
+        }
+        const char *fields[6];
+        size_t lengths[6];
+        const char *p = line;
+        int nf = 0;
+        for (; nf < 6 && p < eol; nf++) {
+            const char *end = (const char *) memchr(p, ' ', eol - p);
+            if (!end) {
+                end = eol;
+            }
+            fields[nf] = p;
+            lengths[nf] = end - p;
+            p = end + 1;
+        }
+        // p is just past the space ending the options, so the separator may start right there
+        const char *dash = strstr(p - 1, " - ");
+        if (nf < 6 || !dash || dash >= eol) {
+            line = *eol ? eol + 1 : eol;
+            continue;
+        }
+        const char *type = dash + 3;
+        const char *type_end = (const char *) memchr(type, ' ', eol - type);
+        const char *source = type_end ? type_end + 1 : eol;
+        const char *source_end = (const char *) memchr(source, ' ', eol - source);
+        if (!source_end) {
+            source_end = eol;
+        }
+
+        std::string t(type, type_end ? type_end - type : eol - type);
+        // A bind mount shows part of a filesystem that's also mounted whole.
+        // A root other than "/" alone isn't one: btrfs subvolumes (/@, /@home) are mounted that way.
+        bool bind = (lengths[3] != 1 || fields[3][0] != '/') && whole.count(std::string(fields[2], lengths[2]));
+        std::string path = unescape(fields[4], lengths[4]);
+        // a container's root is an overlay; on the host, the containers' layers are clutter
+        bool layer = t == "overlay" && path != "/";
+        if (!in_list(ignored_types, t) && !bind && !layer) {
+            std::string device = unescape(source, source_end - source);
+            Mount *m = find(path, device);
+            if (!m) {
+                m = new Mount;
+                m->path = path;
+                m->device = device;
+                m->type = t;
+                m->network = in_list(network_types, t);
+                m->disk = disk_name(std::string(fields[2], lengths[2]).c_str());
+            }
+            m->seen = true;
+            list.push_back(m);
+        }
+        line = *eol ? eol + 1 : eol;
+    }
+#endif
+
+    for (auto *m: mounts) {
+        if (!m->seen) {
+            // unmounted; an outstanding query keeps its own reference
+            delete m;
+        }
+    }
+    mounts = list;
+}
+
+void Filesystem::stat(Mount *m) {
+    if (!m->network) {
+        struct statvfs st{};
+        if (statvfs(m->path.c_str(), &st) == 0) {
+            m->set(st);
+        }
+        return;
+    }
+
+    if (m->query) {
+        if (!m->query->done.load(std::memory_order_acquire)) {
+            if (now_ms() - m->query->started > FILESYSTEM_STAT_TIMEOUT_MS) {
+                m->hung = true;
+            }
+            // still waiting; never start a second query for the same mount
+            return;
+        }
+        if (m->query->ok) {
+            m->set(m->query->result);
+        }
+        m->query.reset();
+    }
+
+    auto query = std::make_shared<StatQuery>();
+    query->path = m->path;
+    query->started = now_ms();
+    m->query = query;
+    std::thread([query]() {
+        query->ok = statvfs(query->path.c_str(), &query->result) == 0;
+        query->done.store(true, std::memory_order_release);
+    }).detach();
+}
+
+void Filesystem::update() {
+    if (changed()) {
+        dirty = true;
+    }
+    if (dirty) {
+        read_mounts();
+        dirty = false;
+    }
+    for (auto *m: mounts) {
+        stat(m);
+        if (m->valid && m->size == 0) {
+            // proc, sysfs and the like
+            continue;
+        }
+        // fs/MOUNT POINT/size and so on; gaps while it can't be read
+        bool ok = m->valid && !m->hung;
+        std::string name = "fs/" + m->path + "/";
+        history().series(name + "size")->append(ok ? float(m->size) : HISTORY_GAP);
+        history().series(name + "used")->append(ok ? float(m->used) : HISTORY_GAP);
+        history().series(name + "avail")->append(ok ? float(m->avail) : HISTORY_GAP);
+        history().series(name + "inodes")->append(ok ? float(m->inodes) : HISTORY_GAP);
+        history().series(name + "inodes_free")->append(ok ? float(m->inodes_free) : HISTORY_GAP);
+    }
+}
+
+void Filesystem::load(const RecordingReader &reader) {
+    for (auto *m: mounts) {
+        delete m;
+    }
+    mounts.clear();
+    std::map<std::string, Mount *> by_path;
+    reader.each_device("fs", [&](const std::string &path, const char *measurement, float value) {
+        Mount *&m = by_path[path];
+        if (!m) {
+            m = new Mount;
+            m->path = path;
+            m->valid = true;
+            mounts.push_back(m);
+        }
+        if (std::isnan(value)) {
+            m->valid = false;
+            return;
+        }
+        auto n = uint64_t(value);
+        if (!strcmp(measurement, "size")) {
+            m->size = n;
+        } else if (!strcmp(measurement, "used")) {
+            m->used = n;
+        } else if (!strcmp(measurement, "avail")) {
+            m->avail = n;
+        } else if (!strcmp(measurement, "inodes")) {
+            m->inodes = n;
+        } else if (!strcmp(measurement, "inodes_free")) {
+            m->inodes_free = n;
+        }
+    });
+}
+
+// keep the tail of long mount points, it's the part that tells them apart
+static const char *tail(const std::string &s, size_t width) {
+    return s.size() > width ? &s.c_str()[s.size() - width] : s.c_str();
+}
+
+static void printPercent(double pct) {
+    if (pct >= 90) {
+        console.fg_red();
+        console.mode_bold();
+    } else if (pct >= 80) {
+        console.fg_yellow();
+    }
+    console.write(Percent(pct, 5, 1));
+    console.mode_clear();
+}
+
+uint16_t Filesystem::rows() const {
+    uint16_t count = 1;
+    if (!options.condenseFilesystems) {
+        for (auto *m: mounts) {
+            if (!m->valid || m->size != 0) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+uint16_t Filesystem::print(bool newline) {
+    uint16_t count = 0;
+    bool wide = console.width >= 110;
+
+    if (wide) {
+        console.inverseln("  %-20s %10s %10s %10s %6s %6s  %-8s %13s %13s", "[F]ILESYSTEMS", "Size", "Used", "Avail",
+                          "Use", "Inodes", "Disk", "Read (B/s)", "Write (B/s)");
+    } else {
+        console.inverseln("  %-20s %10s %10s %10s %6s %6s  %-8s", "[F]ILESYSTEMS", "Size", "Used", "Avail",
+                          "Use", "Inodes", "Disk");
+    }
+    count++;
+
+    if (!options.condenseFilesystems) {
+        for (auto *m: mounts) {
+            if (m->valid && m->size == 0) {
+                continue;
+            }
+            console.write("  ", Text(tail(m->path, 20), -20), ' ');
+            if (!m->valid || m->hung) {
+                console.fg_red();
+                console.print("%10s", m->hung ? "hung" : "-");
+                console.mode_clear();
+                console.newline();
+                count++;
+                continue;
+            }
+            console.write(HumanSize(m->size, 10), ' ', HumanSize(m->used, 10), ' ', HumanSize(m->avail, 10), ' ');
+            printPercent(m->size ? 100. * double(m->used) / double(m->size) : 0);
+            console.print(" ");
+            if (m->inodes) {
+                printPercent(100. * double(m->inodes - m->inodes_free) / double(m->inodes));
+            } else {
+                console.print("%6s", "-");
+            }
+            console.write("  ", Text(m->network ? m->type : m->disk, -8));
+
+            DiskStats *stats = m->disk.empty() ? nullptr : disk.find(m->disk.c_str());
+            if (wide && stats) {
+                console.write(' ', Grouped(int64_t(disk.per_second(stats->total_read_bytes)), 13),
+                              ' ', Grouped(int64_t(disk.per_second(stats->total_written_bytes)), 13));
+            }
+            console.newline();
+            count++;
+        }
+    }
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Filesystem filesystem;
@@ -0,0 +1,118 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_FILESYSTEM_H
+#define CCTOP_FILESYSTEM_H
+
+#include "../lib/Recording.h"
+#include "../lib/SysFile.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/statvfs.h>
+#include <vector>
+
+// how long a network filesystem's statvfs() may take before it's shown as hung
+const int FILESYSTEM_STAT_TIMEOUT_MS = 500;
+
+// An outstanding statvfs() for a network filesystem, run on its own thread.
+// Shared with the thread, so a query that never comes back (hung NFS server)
+// is simply abandoned.
+struct StatQuery {
+    std::string path;
+    int64_t started{};
+    struct statvfs result{};
+    bool ok{false};
+    std::atomic<bool> done{false};
+};
+
+struct Mount {
+    std::string device;  // e.g. /dev/sda1 or server:/export
+    std::string path;    // mount point
+    std::string type;    // e.g. ext4, apfs, nfs4
+    std::string disk;    // whole disk in the disk panel, e.g. sda or disk3 (may be empty)
+    bool network{false};
+    bool seen{false};
+
+    // from statvfs, in bytes
+    bool valid{false}, hung{false};
+    uint64_t size{}, used{}, avail{};
+    uint64_t inodes{}, inodes_free{};
+
+    std::shared_ptr<StatQuery> query;
+
+    void set(const struct statvfs &st);
+};
+
+//
+// Mounted filesystem capacity and inode usage.
+//
+// The mount table is only re-read when it changes: on Linux poll() on
+// /proc/self/mountinfo reports POLLPRI when something is mounted or
+// unmounted; on MacOS a kqueue EVFILT_FS filter does the same.
+//
+// statvfs() on a network filesystem can block indefinitely when the server
+// goes away, so those are done on a worker thread and the display never
+// waits for them.
+//
+class Filesystem {
+public:
+    std::vector<Mount *> mounts;
+
+public:
+    Filesystem();
+
+    ~Filesystem();
+
+public:
+    // descriptor that becomes ready when the mount table changes (-1 if none)
+    int changes_descriptor() const { return changes_fd; }
+
+    // the event loop saw changes_descriptor() become ready
+    void changes_ready();
+
+    void update();
+
+    // header plus a row per mount shown
+    uint16_t rows() const;
+
+    // print the filesystem stats, return # lines printed
+    uint16_t print(bool newline);
+
+    // replay: show the reader's last frame instead of what update() read
+    void load(const RecordingReader &reader);
+
+protected:
+    SysFile *mountinfo{nullptr};
+    int changes_fd{-1};
+    bool dirty{true};
+
+    bool changed();
+
+    void read_mounts();
+
+    Mount *find(const std::string &path, const std::string &device);
+
+    void stat(Mount *m);
+};
+
+extern Filesystem filesystem;
+
+#endif //CCTOP_FILESYSTEM_H
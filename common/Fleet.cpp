@@ -0,0 +1,267 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Fleet.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+// the columns before BUSIEST, which gets the rest
+static const int FLEET_FIXED_WIDTH = 77;
+
+// what the table shows for a host, from its last frame
+struct Headline {
+    float cpu{HISTORY_GAP}, used{HISTORY_GAP}, total{HISTORY_GAP};
+    float disk{HISTORY_GAP}, net{HISTORY_GAP};
+    const char *busiest{nullptr};
+};
+
+static void add(float &to, float value) {
+    if (!std::isnan(value)) {
+        to = std::isnan(to) ? value : to + value;
+    }
+}
+
+static Headline headline(const RecordingReader &reader) {
+    Headline h;
+    for (const auto &v: reader.values) {
+        const std::string &name = reader.series_names[v.first];
+        if (name == "cpu/CPU") {
+            h.cpu = v.second;
+        } else if (name == "memory/used") {
+            h.used = v.second;
+        } else if (name == "memory/total") {
+            h.total = v.second;
+        } else if (name == "disk/read" || name == "disk/write") {
+            add(h.disk, v.second);
+        } else if (name == "net/rx" || name == "net/tx") {
+            add(h.net, v.second);
+        }
+    }
+    int32_t most = -1;
+    for (const auto &it: reader.processes) {
+        if (it.second.cpu > most) {
+            most = it.second.cpu;
+            h.busiest = reader.names[it.second.name].c_str();
+        }
+    }
+    return h;
+}
+
+static void printPercent(float value, int width) {
+    if (std::isnan(value)) {
+        console.write(Text("-", width));
+    } else {
+        console.write(Percent(value, width, 1));
+    }
+}
+
+static void printSize(float value, int width) {
+    if (std::isnan(value)) {
+        console.write(Text("-", width));
+    } else {
+        console.write(HumanSize(uint64_t(value), width));
+    }
+}
+
+void Fleet::open(const char *addresses, std::function<void()> changed) {
+    on_change = std::move(changed);
+    for (const char *p = addresses; *p;) {
+        const char *comma = strchr(p, ',');
+        std::string address = comma ? std::string(p, comma) : std::string(p);
+        p = comma ? comma + 1 : p + address.size();
+        if (address.empty()) {
+            continue;
+        }
+        if (hosts.size() == FLEET_MAX_HOSTS) {
+            console.abort("cctop: --connect: more than %zu hosts\n", FLEET_MAX_HOSTS);
+        }
+        hosts.emplace_back(new Host);
+        Host *host = hosts.back().get();
+        host->address = address;
+        bool ok = host->stream.open(address.c_str(), [this, host](bool frame) {
+            // the table catches up on the tick; only the host being shown is drawn as it comes
+            if (host != shown) {
+                return;
+            }
+            if (frame) {
+                load_history(host->stream.reader);
+                load_panels(host->stream.reader);
+            } else {
+                on_change();
+            }
+        });
+        if (!ok) {
+            console.abort("cctop: %s: %s\n", address.c_str(), strerror(errno));
+        }
+        // one that's down shows as down until tick() gets through
+        host->stream.connect();
+    }
+}
+
+void Fleet::tick() {
+    for (auto &host: hosts) {
+        host->stream.connect();
+    }
+}
+
+void Fleet::drill(Host *host) {
+    static const RecordingReader nothing;
+    shown = host;
+    // the graphs start over with this host's frames
+    history().clear();
+    if (host && host->stream.frames) {
+        load_history(host->stream.reader);
+    }
+    // and the panels with its last frame, or empty ones until it sends one
+    load_panels(host ? host->stream.reader : nothing);
+    console.clear();
+}
+
+bool Fleet::key(int c) {
+    if (shown) {
+        if (c == 0x1b) {
+            drill(nullptr);
+            return true;
+        }
+        // the process list's, and the rest
+        return false;
+    }
+    size_t last = hosts.size() - 1, page = std::max(console.height - 4, 1);
+    switch (c) {
+        case CONSOLE_KEY_UP:
+            selected = selected > 0 ? selected - 1 : 0;
+            return true;
+        case CONSOLE_KEY_DOWN:
+            selected = std::min(selected + 1, last);
+            return true;
+        case CONSOLE_KEY_PAGE_UP:
+            selected = selected > page ? selected - page : 0;
+            return true;
+        case CONSOLE_KEY_PAGE_DOWN:
+            selected = std::min(selected + page, last);
+            return true;
+        case CONSOLE_KEY_HOME:
+            selected = 0;
+            return true;
+        case CONSOLE_KEY_END:
+            selected = last;
+            return true;
+        case '\r':
+        case '\n':
+            drill(hosts[selected].get());
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint16_t Fleet::rows() const {
+    // header, a row per host and the count
+    return shown ? 0 : uint16_t(std::min(hosts.size(), size_t(UINT16_MAX - 2)) + 2);
+}
+
+uint16_t Fleet::print(bool newline) {
+    uint16_t count = 0;
+    int rest = std::max(console.width - FLEET_FIXED_WIDTH, 8);
+    console.inverseln("  %-20.20s %-12.12s %6.6s %6.6s %9.9s %9.9s %6.6s %-*.*s", "HOST", "STATUS",
+                      "CPU%", "MEM%", "DISK B/s", "NET B/s", "PROCS", rest, rest, "BUSIEST");
+    count++;
+
+    // whatever the viewport has left after the count line (and the blank line)
+    int lines = console.height - console.cursor_row() - 1 - (newline ? 1 : 0);
+    size_t page = size_t(std::max(lines, 1));
+    if (selected < first) {
+        first = selected;
+    } else if (selected >= first + page) {
+        first = selected - page + 1;
+    }
+    size_t last = std::min(hosts.size(), first + page), connected = 0;
+    for (const auto &host: hosts) {
+        connected += host->stream.state() == FrameStream::OPEN;
+    }
+    for (size_t i = first; i < last; i++) {
+        const Host &host = *hosts[i];
+        Headline h;
+        if (host.stream.frames) {
+            h = headline(host.stream.reader);
+        }
+        if (i == selected) {
+            console.mode_inverse(true);
+        }
+        console.write("  ", Text(host.address.c_str(), -20), ' ', Text(host.stream.status(), -12), ' ');
+        printPercent(h.cpu, 6);
+        console.write(' ');
+        printPercent(h.total > 0 ? h.used / h.total * 100 : HISTORY_GAP, 6);
+        console.write(' ');
+        printSize(h.disk, 9);
+        console.write(' ');
+        printSize(h.net, 9);
+        console.write(' ');
+        if (host.stream.frames) {
+            console.write(Number(int64_t(host.stream.reader.processes.size()), 6));
+        } else {
+            console.write(Text("-", 6));
+        }
+        console.write(' ', Text(h.busiest ? h.busiest : "-", -rest));
+        console.mode_clear();
+        console.newline();
+        count++;
+    }
+    console.print("  %zu hosts, %zu connected", hosts.size(), connected);
+    if (first > 0 || last < hosts.size()) {
+        console.print(", %zu-%zu shown", first + 1, last);
+    }
+    console.print("  (Up/Down, Enter shows one)");
+    console.newline();
+    count++;
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+uint16_t Fleet::host_rows() const {
+    // the panels below show the host's frames
+    return shown ? 1 : 0;
+}
+
+uint16_t Fleet::print_host(bool newline) {
+    uint16_t count = 0;
+    char when[32] = "-";
+    if (shown->stream.frames) {
+        time_t t = time_t(shown->stream.reader.decoded_ms() / 1000);
+        tm local{};
+        localtime_r(&t, &local);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    console.inverseln("  [HOST] %s  %s  %s  (Esc: back to the fleet)", shown->address.c_str(), when,
+                      shown->stream.status());
+    count++;
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Fleet fleet;
@@ -0,0 +1,90 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_FLEET_H
+#define CCTOP_FLEET_H
+
+#include "../lib/FrameStream.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// hosts one viewer takes
+const size_t FLEET_MAX_HOSTS = 256;
+
+//
+// -c with more than one address: a table of agents (cctop -d on a TCP
+// port, or a unix socket) with each one's CPU, memory, disk and network
+// headlines and its busiest process.  Every agent is a FrameStream on the
+// one event loop, so watching fifty costs fifty sockets and the decoding
+// of what they send, and the table is worked out from their last frames
+// only when it's drawn.
+//
+// Up/Down pick a host and Enter drills into it: its frames then go to
+// history() and the panels (load_panels()) as they arrive, and it's shown
+// the way -c shows a single daemon, until Esc goes back to the table.
+//
+class Fleet {
+public:
+    bool active() const { return !hosts.empty(); }
+
+    // showing one host rather than the table
+    bool drilled() const { return shown != nullptr; }
+
+    // the comma separated addresses; exits with a message if one isn't
+    // an address.  changed() is called whenever there's news.
+    void open(const char *addresses, std::function<void()> changed);
+
+    // the timer: reconnect any that went away
+    void tick();
+
+    // true if c was a fleet key
+    bool key(int c);
+
+public:
+    // the table; 0 when drilled in
+    uint16_t rows() const;
+
+    uint16_t print(bool newline);
+
+    // the host drilled into; 0 when showing the table
+    uint16_t host_rows() const;
+
+    uint16_t print_host(bool newline);
+
+protected:
+    struct Host {
+        std::string address;
+        FrameStream stream;
+    };
+
+    std::vector<std::unique_ptr<Host>> hosts;
+    Host *shown{nullptr};
+    size_t selected{0}, first{0}; // selected row, and the first one on screen
+    std::function<void()> on_change;
+
+    void drill(Host *host);
+};
+
+extern Fleet fleet;
+
+#endif //CCTOP_FLEET_H
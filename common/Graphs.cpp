@@ -0,0 +1,124 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Graphs.h"
+
+Graphs::Graphs() {
+    plots = {
+            {"CPU",        "cpu/CPU",    Plot::PERCENT, &Console::fg_green,   Graph(GRAPHS_ROWS)},
+            {"Memory",     "memory/used", Plot::MEMORY, &Console::fg_yellow,  Graph(GRAPHS_ROWS)},
+            {"Net RX",     "net/rx",     Plot::BYTES,   &Console::fg_cyan,    Graph(GRAPHS_ROWS)},
+            {"Net TX",     "net/tx",     Plot::BYTES,   &Console::fg_blue,    Graph(GRAPHS_ROWS)},
+            {"Disk Read",  "disk/read",  Plot::BYTES,   &Console::fg_magenta, Graph(GRAPHS_ROWS)},
+            {"Disk Write", "disk/write", Plot::BYTES,   &Console::fg_red,     Graph(GRAPHS_ROWS)},
+            {"Disk Ops",   "disk/ops",   Plot::COUNT,   &Console::fg_white,   Graph(GRAPHS_ROWS)},
+    };
+}
+
+// value (or scale) of a plot, 10 wide
+static void printValue(const Plot &plot, float value) {
+    if (std::isnan(value)) {
+        console.print("%10s", "-");
+        return;
+    }
+    switch (plot.kind) {
+        case Plot::PERCENT:
+            console.write(Percent(value, 9, 1));
+            break;
+        case Plot::MEMORY:
+        case Plot::BYTES:
+            console.write(HumanSize(uint64_t(value), 10));
+            break;
+        default:
+            console.write(Grouped(int64_t(value), 10));
+            break;
+    }
+}
+
+uint16_t Graphs::rows() const {
+    if (!options.showGraphs || console.width <= GRAPHS_LABEL_WIDTH + 1) {
+        return 0;
+    }
+    return uint16_t(1 + plots.size() * GRAPHS_ROWS);
+}
+
+uint16_t Graphs::print(bool newline) {
+    if (!options.showGraphs) {
+        return 0;
+    }
+    uint16_t count = 0;
+    int columns = console.width - GRAPHS_LABEL_WIDTH - 1;
+    if (columns < 1) {
+        return 0;
+    }
+
+    char span[64];
+    uint32_t seconds = uint32_t(columns) * GRAPH_DOTS_X * options.read_timeout / 1000;
+    sprintf(span, "last %um%02us", seconds / 60, seconds % 60);
+    console.inverseln("  %-12s %-21s", "[G]RAPHS", span);
+    count++;
+
+    for (auto &plot: plots) {
+        const Series *series = history().find(plot.series);
+        float max = 0;
+        switch (plot.kind) {
+            case Plot::PERCENT:
+                max = 100;
+                break;
+            case Plot::MEMORY: {
+                // from history, so a replay is scaled to the machine it recorded
+                const Series *total = history().find("memory/total");
+                max = total ? total->latest() : 0;
+                break;
+            }
+            default:
+                max = series ? series->peak(uint32_t(columns) * GRAPH_DOTS_X) : 0;
+                break;
+        }
+        plot.graph.plot(series, uint16_t(columns), max);
+
+        for (int r = 0; r < plot.graph.rows(); r++) {
+            if (r == 0) {
+                console.write("  ", Text(plot.label, -11), ' ');
+                printValue(plot, series ? series->latest() : HISTORY_GAP);
+            } else {
+                // what a full graph is
+                console.write("  ", Text("max", 11), ' ');
+                printValue(plot, max);
+            }
+            console.print(" ");
+            (console.*plot.color)();
+            const wchar_t *glyphs = plot.graph.row(r);
+            for (int c = 0; c < plot.graph.columns(); c++) {
+                console.write(glyphs[c]);
+            }
+            console.mode_clear();
+            console.newline();
+            count++;
+        }
+    }
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Graphs graphs;
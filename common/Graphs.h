@@ -0,0 +1,66 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_GRAPHS_H
+#define CCTOP_GRAPHS_H
+
+#include "../lib/Console.h"
+#include "../lib/Graph.h"
+#include <cstdint>
+#include <vector>
+
+// rows per graph, and the label/value columns to their left
+const int GRAPHS_ROWS = 2, GRAPHS_LABEL_WIDTH = 24;
+
+struct Plot {
+    enum {
+        PERCENT, // 0-100
+        MEMORY,  // bytes, of the memory size
+        BYTES,   // bytes per second, scaled to the peak
+        COUNT,   // per second, scaled to the peak
+    };
+    const char *label;
+    const char *series; // name in history()
+    int kind;
+    void (Console::*color)();
+    Graph graph;
+};
+
+//
+// Braille graphs of the longer term history: CPU, memory, network and disk
+// throughput, and disk operations.  As many samples as fit across the
+// window are shown, two per column.  Toggled with G.
+//
+class Graphs {
+public:
+    std::vector<Plot> plots;
+
+public:
+    Graphs();
+
+public:
+    // none unless options.showGraphs
+    uint16_t rows() const;
+
+    uint16_t print(bool newline);
+};
+
+extern Graphs graphs;
+
+#endif //CCTOP_GRAPHS_H
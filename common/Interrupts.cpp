@@ -0,0 +1,310 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Interrupts.h"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static inline bool is_digit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+#ifdef __SSE2__
+// 16 bytes at a time: skip the runs of blanks that make up most of a wide row
+static inline const char *skip_blanks(const char *p, const char *end) {
+    const __m128i blank = _mm_set1_epi8(' ');
+    while (p + 16 <= end) {
+        __m128i v = _mm_loadu_si128((const __m128i *) p);
+        auto mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, blank)));
+        if (mask != 0xffff) {
+            return p + __builtin_ctz(~mask);
+        }
+        p += 16;
+    }
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// length of the run of digits at p (at most 16 when it can look ahead)
+static inline int digit_run(const char *p, const char *end) {
+    if (p + 16 <= end) {
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i *) p), _mm_set1_epi8('0'));
+        // unsigned v <= 9
+        __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(9)), v);
+        auto mask = unsigned(_mm_movemask_epi8(digits));
+        if (mask != 0xffff) {
+            return __builtin_ctz(~mask);
+        }
+    }
+    int n = 0;
+    while (p + n < end && is_digit(p[n])) {
+        n++;
+    }
+    return n;
+}
+#else
+static inline const char *skip_blanks(const char *p, const char *end) {
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static inline int digit_run(const char *p, const char *end) {
+    int n = 0;
+    while (p + n < end && is_digit(p[n])) {
+        n++;
+    }
+    return n;
+}
+#endif
+
+int scan_columns(const char *p, const char *end, uint64_t *out, int n, const char **next) {
+    int count = 0;
+    while (count < n) {
+        const char *q = skip_blanks(p, end);
+        int len = digit_run(q, end);
+        if (len == 0 || (q + len < end && !is_space(q[len]) && q[len] != '\n')) {
+            // not a number, so the description starts here
+            break;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < len; i++) {
+            value = value * 10 + (q[i] - '0');
+        }
+        out[count++] = value;
+        p = q + len;
+    }
+    *next = p;
+    return count;
+}
+
+IRQTable::IRQTable(const char *path, const char *aKind) {
+    kind = aKind;
+    file = new SysFile(path);
+    update();
+}
+
+IRQTable::~IRQTable() {
+    delete file;
+    file = nullptr;
+}
+
+void IRQTable::resize() {
+    cpu_ids = header;
+    num_cpus = int(cpu_ids.size());
+    last.assign(rows.size() * num_cpus, 0);
+    current.assign(rows.size() * num_cpus, 0);
+    delta.assign(rows.size() * num_cpus, 0);
+    for (auto &r: rows) {
+        r.primed = false;
+    }
+}
+
+size_t IRQTable::row(const char *label, size_t len, size_t expected) {
+    // rows almost always come back in the same order, so try that first
+    if (expected < rows.size() && rows[expected].label.size() == len &&
+        !memcmp(rows[expected].label.data(), label, len)) {
+        return expected;
+    }
+    std::string key(label, len);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        return it->second;
+    }
+    size_t ndx = rows.size();
+    rows.push_back(IRQRow{key, "", "", false, false});
+    index.emplace(key, ndx);
+    last.resize(rows.size() * num_cpus, 0);
+    current.resize(rows.size() * num_cpus, 0);
+    delta.resize(rows.size() * num_cpus, 0);
+    return ndx;
+}
+
+void IRQTable::update() {
+    size_t length;
+    const char *p = file->read(&length);
+    if (!p) {
+        return;
+    }
+    interval.stamp();
+    const char *end = p + length;
+
+    // header is CPU0 CPU1 ... for online cpus, so with one offline the
+    // column numbers aren't the CPU numbers
+    const char *eol = (const char *) memchr(p, '\n', end - p);
+    if (!eol) {
+        return;
+    }
+    header.clear();
+    for (const char *q = p; (q = (const char *) memmem(q, eol - q, "CPU", 3)); ) {
+        q += 3;
+        int id = 0;
+        while (q < eol && *q >= '0' && *q <= '9') {
+            id = id * 10 + (*q++ - '0');
+        }
+        header.push_back(id);
+    }
+    if (header != cpu_ids) {
+        resize();
+    }
+    std::swap(last, current);
+
+    for (auto &r: rows) {
+        r.seen = false;
+    }
+
+    size_t line = 0;
+    for (p = eol + 1; p < end; p = eol + 1, line++) {
+        eol = (const char *) memchr(p, '\n', end - p);
+        if (!eol) {
+            eol = end;
+        }
+        const char *label = skip_blanks(p, eol);
+        auto *colon = (const char *) memchr(label, ':', eol - label);
+        if (!colon) {
+            continue;
+        }
+        size_t ndx = row(label, colon - label, line);
+        IRQRow &r = rows[ndx];
+        r.seen = true;
+
+        uint64_t *counters = &current[ndx * num_cpus];
+        const char *next;
+        int n = scan_columns(colon + 1, eol, counters, num_cpus, &next);
+        // ERR: and MIS: only have one column
+        memset(&counters[n], 0, (num_cpus - n) * sizeof(uint64_t));
+
+        next = skip_blanks(next, eol);
+        size_t dlen = eol - next;
+        if (r.raw.size() != dlen || memcmp(r.raw.data(), next, dlen) != 0) {
+            // the columns are padded for alignment; squeeze the blanks out
+            // so more of the device name fits in the panel
+            r.raw.assign(next, dlen);
+            r.description.clear();
+            for (size_t i = 0; i < dlen; i++) {
+                if (!is_space(next[i]) || (i + 1 < dlen && !is_space(next[i + 1]))) {
+                    r.description += next[i];
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        uint64_t *d = &delta[i * num_cpus];
+        const uint64_t *c = &current[i * num_cpus], *l = &last[i * num_cpus];
+        if (!rows[i].seen || !rows[i].primed) {
+            // new (or vanished) IRQ, no previous sample to diff against
+            memset(d, 0, num_cpus * sizeof(uint64_t));
+            rows[i].primed = rows[i].seen;
+            continue;
+        }
+        for (int cpu = 0; cpu < num_cpus; cpu++) {
+            d[cpu] = c[cpu] >= l[cpu] ? c[cpu] - l[cpu] : 0;
+        }
+    }
+}
+
+Interrupts::Interrupts() : hard("/proc/interrupts", "IRQ"), soft("/proc/softirqs", "Soft") {
+    hottest.reserve(INTERRUPTS_HOTTEST + 1);
+}
+
+// keep the INTERRUPTS_HOTTEST busiest cells, sorted descending
+static void consider(std::vector<IRQCell> &hottest, const IRQTable &table) {
+    size_t cells = table.delta.size();
+    const uint64_t *d = table.delta.data();
+    for (size_t i = 0; i < cells; i++) {
+        uint64_t count = d[i];
+        if (count == 0 || (hottest.size() == size_t(INTERRUPTS_HOTTEST) && count <= hottest.back().count)) {
+            continue;
+        }
+        IRQCell cell{&table, i / table.num_cpus, table.cpu_ids[i % table.num_cpus], count};
+        auto it = hottest.begin();
+        while (it != hottest.end() && it->count >= count) {
+            it++;
+        }
+        hottest.insert(it, cell);
+        if (hottest.size() > size_t(INTERRUPTS_HOTTEST)) {
+            hottest.pop_back();
+        }
+    }
+}
+
+void Interrupts::update() {
+    if (!hard.ok() && !soft.ok()) {
+        return;
+    }
+    hard.update();
+    soft.update();
+
+    hottest.clear();
+    consider(hottest, hard);
+    consider(hottest, soft);
+}
+
+uint16_t Interrupts::rows() const {
+    if (!hard.ok() && !soft.ok()) {
+        return 0;
+    }
+    return options.condenseInterrupts ? 1 : uint16_t(1 + std::max(hottest.size(), size_t(1)));
+}
+
+uint16_t Interrupts::print(bool newline) {
+    if (!hard.ok() && !soft.ok()) {
+        // MacOS, or /proc not mounted
+        return 0;
+    }
+    uint16_t count = 0;
+
+    console.inverseln("  %-16s %4s %6s %13s  %s", "[I]NTERRUPTS", "Type", "CPU", "Per Second", "Source");
+    count++;
+    if (!options.condenseInterrupts) {
+        int width = console.width - 48;
+        for (const auto &cell: hottest) {
+            const IRQRow &r = cell.table->rows[cell.row];
+            char cpu[16];
+            sprintf(cpu, "CPU%d", cell.cpu);
+            console.writeln("  ", Text(r.label, -16), ' ', Text(cell.table->kind, 4, 0), ' ', Text(cpu, 6, 0),
+                            ' ', Grouped(int64_t(cell.table->interval.per_second(double(cell.count))), 13), "  ",
+                            Text(width > 0 ? r.description.c_str() : "", 0, width > 0 ? width : 0));
+            count++;
+        }
+        if (hottest.empty()) {
+            console.println("  %-16s", "(idle)");
+            count++;
+        }
+    }
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Interrupts interrupts;
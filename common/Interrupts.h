@@ -0,0 +1,113 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_INTERRUPTS_H
+#define CCTOP_INTERRUPTS_H
+
+#include "../lib/Clock.h"
+#include "../lib/SysFile.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const int INTERRUPTS_HOTTEST = 6;
+
+struct IRQRow {
+    std::string label;        // e.g. 24, NMI, LOC, NET_RX
+    std::string description;  // e.g. IR-PCI-MSI 524288-edge eth0-TxRx-0
+    std::string raw;          // description as read, with its padding
+    bool seen{false};   // present in the latest read
+    bool primed{false}; // has a previous sample to diff against
+};
+
+//
+// Per IRQ, per CPU counters from a /proc/interrupts style table, kept as
+// rows x cpus matrices so the delta is a straight subtraction.
+//
+// On big hosts the rows are thousands of columns wide, so the numbers are
+// pulled out by scan_columns() (SIMD where available) instead of Parser's
+// token at a time allocation.
+//
+class IRQTable {
+public:
+    const char *kind;
+    int num_cpus{0};
+    std::vector<int> cpu_ids; // the CPU each column is for; offline ones have no column
+    std::vector<IRQRow> rows;
+    std::vector<uint64_t> last, current, delta;
+    Interval interval; // between the last two reads
+
+public:
+    IRQTable(const char *path, const char *kind);
+
+    ~IRQTable();
+
+public:
+    bool ok() const { return file && file->ok(); }
+
+    void update();
+
+protected:
+    SysFile *file;
+    std::unordered_map<std::string, size_t> index;
+    std::vector<int> header; // cpu_ids as the last read has them
+
+    size_t row(const char *label, size_t len, size_t expected);
+
+    // new columns: start over
+    void resize();
+};
+
+// a cell of one of the delta matrices
+struct IRQCell {
+    const IRQTable *table;
+    size_t row;
+    int cpu; // the CPU's number, not its column
+    uint64_t count;
+};
+
+class Interrupts {
+public:
+    IRQTable hard, soft;
+
+public:
+    Interrupts();
+
+public:
+    void update();
+
+    // 0 where there's nothing to show
+    uint16_t rows() const;
+
+    // print the busiest IRQ/CPU cells, return # lines printed
+    uint16_t print(bool newline);
+
+protected:
+    std::vector<IRQCell> hottest;
+};
+
+// Parse up to n whitespace separated decimal counters starting at p into out.
+// Stops at the first token that isn't a number (the IRQ description).  Returns
+// the number of counters parsed and sets *next past the last one.
+int scan_columns(const char *p, const char *end, uint64_t *out, int n, const char **next);
+
+extern Interrupts interrupts;
+
+#endif //CCTOP_INTERRUPTS_H
@@ -0,0 +1,154 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "ProcessFilter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <pwd.h>
+#include <sstream>
+#include <unistd.h>
+
+bool ProcessFilter::key(int c) {
+    switch (c) {
+        case '\r':
+        case '\n':
+            editing = false;
+            return true;
+        case 0x1b:
+            // escape throws the filter away
+            text.clear();
+            editing = false;
+            break;
+        case 8:
+        case 127:
+            if (!text.empty()) {
+                text.pop_back();
+            }
+            break;
+        default:
+            if (c < 0x20 || c > 0x7e) {
+                return false;
+            }
+            text += char(c);
+            break;
+    }
+    compile();
+    return true;
+}
+
+void ProcessFilter::compile() {
+    names.clear();
+    cgroups.clear();
+    uids.clear();
+    pid_low = 0;
+    pid_high = INT64_MAX;
+
+    std::istringstream terms(text);
+    std::string term;
+    while (terms >> term) {
+        for (auto &c: term) {
+            c = char(tolower((unsigned char) c));
+        }
+        size_t colon = term.find(':');
+        std::string kind = colon == std::string::npos ? "" : term.substr(0, colon),
+                value = colon == std::string::npos ? term : term.substr(colon + 1);
+        if (kind == "user" || kind == "u") {
+            char *end;
+            long uid = strtol(value.c_str(), &end, 10);
+            if (end != value.c_str() && *end == '\0') {
+                uids.push_back(uid_t(uid));
+            } else {
+                passwd *pass = getpwnam(value.c_str());
+                uids.push_back(pass ? pass->pw_uid : uid_t(-1));
+            }
+        } else if (kind == "pid" || kind == "p") {
+            char *end;
+            int64_t low = strtoll(value.c_str(), &end, 10),
+                    high = *end == '-' ? strtoll(end + 1, nullptr, 10) : low;
+            // narrow what's there, so two pid: terms still mean both
+            pid_low = std::max(pid_low, low);
+            pid_high = std::min(pid_high, high);
+        } else if (kind == "cg" || kind == "cgroup") {
+            cgroups.push_back(value);
+        } else if (!term.empty()) {
+            // including unknown kinds, as a plain name
+            names.push_back({term, {}, false});
+        }
+    }
+}
+
+bool ProcessFilter::match(const NamePool &pool, uint32_t name_id, uid_t uid) {
+    for (auto u: uids) {
+        if (u != uid) {
+            return false;
+        }
+    }
+    for (auto &term: names) {
+        if (!term.searched) {
+            // once per edit, over every name seen so far
+            term.hits.assign(pool.size(), 0);
+            pool.search(term.needle, [&](uint32_t id) { term.hits[id] = 1; });
+            term.searched = true;
+        }
+        while (term.hits.size() <= name_id) {
+            term.hits.push_back(pool.contains(uint32_t(term.hits.size()), term.needle));
+        }
+        if (!term.hits[name_id]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProcessFilter::renamed() {
+    for (auto &term: names) {
+        term.searched = false;
+    }
+}
+
+bool ProcessFilter::cgroup_ok(int pid) const {
+    if (cgroups.empty()) {
+        return true;
+    }
+    char path[64], buf[4096];
+    snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+    for (char *p = buf; *p; p++) {
+        *p = char(tolower((unsigned char) *p));
+    }
+    for (auto &cgroup: cgroups) {
+        if (!strstr(buf, cgroup.c_str())) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_PROCESSFILTER_H
+#define CCTOP_PROCESSFILTER_H
+
+#include "../lib/NamePool.h"
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+//
+// Narrows the process list to what's typed after /.  Space separated
+// terms, all of which have to match:
+//
+//   word        the name contains word, in any case
+//   user:name   the real user, by name or uid
+//   pid:n       that pid, or pid:n-m for a range
+//   cg:word     the cgroup path contains word (nothing matches on MacOS)
+//
+// The text is compiled when it's edited, and collection applies the tests
+// cheapest first: a pid out of range is never read at all, and a process
+// that fails on name or user skips the task, rusage and schedstat reads.
+//
+class ProcessFilter {
+public:
+    std::string text;
+    bool editing{false};
+
+public:
+    bool active() const { return !text.empty(); }
+
+    void edit() { editing = true; }
+
+    // a key while editing; false if it isn't one the filter takes
+    bool key(int c);
+
+public:
+    // before anything is read
+    bool pid_ok(int pid) const { return pid >= pid_low && pid <= pid_high; }
+
+    // after the first (cheap) read; name_id is the name in names
+    bool match(const NamePool &names, uint32_t name_id, uid_t uid);
+
+    // the pool's ids moved (NamePool::sweep), so the name hits are stale
+    void renamed();
+
+    // last, since it's an open and a read per process
+    bool cgroup_ok(int pid) const;
+
+protected:
+    struct NameTerm {
+        std::string needle;         // lowercase
+        std::vector<uint8_t> hits;  // by name id; ids added after the search are checked as they turn up
+        bool searched{false};
+    };
+    std::vector<NameTerm> names;
+    std::vector<std::string> cgroups;
+    std::vector<uid_t> uids;        // an unknown user is -1, which no process has
+    int64_t pid_low{0}, pid_high{INT64_MAX};
+
+    void compile();
+};
+
+#endif //CCTOP_PROCESSFILTER_H
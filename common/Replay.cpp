@@ -0,0 +1,182 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Replay.h"
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+void Replay::open(const char *p) {
+    path = p;
+    if (!reader.open(path)) {
+        console.abort("cctop: %s: %s\n", path, errno == EINVAL ? "not a recording" : strerror(errno));
+    }
+    if (reader.frames() == 0) {
+        console.abort("cctop: %s: nothing recorded\n", path);
+    }
+    opened = true;
+    seek(0);
+}
+
+void Replay::connect(const char *p, std::function<void()> shown) {
+    path = p;
+    streaming = true;
+    on_frame = std::move(shown);
+    if (!stream.open(path, [this](bool frame) {
+        if (frame) {
+            show();
+            load_panels(stream.reader);
+        } else {
+            on_frame();
+        }
+    }) || !stream.connect()) {
+        console.abort("cctop: %s: %s\n", path, strerror(errno));
+    }
+    opened = true;
+}
+
+void load_history(const RecordingReader &reader) {
+    history().begin();
+    for (const auto &v: reader.values) {
+        history().series(reader.series_names[v.first])->append(v.second);
+    }
+    history().end();
+}
+
+void load_panels(const RecordingReader &reader) {
+    processor.load(reader);
+    memory.load(reader);
+    disk.load(reader);
+    filesystem.load(reader);
+    network.load(reader);
+    processList.load(reader);
+}
+
+void Replay::show() {
+    load_history(streaming ? stream.reader : reader);
+}
+
+void Replay::seek(size_t n) {
+    n = std::min(n, reader.frames() - 1);
+    size_t from = n > REPLAY_HISTORY ? n - REPLAY_HISTORY : 0;
+    history().clear();
+    // a frame can only be decoded from its keyframe on
+    for (size_t i = reader.keyframe(from); i <= n; i++) {
+        if (!reader.read(i)) {
+            // damaged; stop at the last good one
+            paused = true;
+            break;
+        }
+        frame = i;
+        if (i >= from) {
+            show();
+        }
+    }
+    // the panels only need the last
+    load_panels(reader);
+}
+
+void Replay::tick() {
+    if (streaming) {
+        // the daemon went away; it may be back
+        stream.connect();
+        return;
+    }
+    if (paused) {
+        return;
+    }
+    if (frame + 1 >= reader.frames() || !reader.read(frame + 1)) {
+        paused = true;
+        return;
+    }
+    frame++;
+    show();
+    load_panels(reader);
+}
+
+bool Replay::key(int c) {
+    if (streaming) {
+        // nothing to seek in
+        return false;
+    }
+    size_t frames = reader.frames();
+    switch (c) {
+        case ' ':
+            paused = !paused;
+            return true;
+        case '.':
+            paused = false;
+            tick();
+            paused = true;
+            return true;
+        case ',':
+            paused = true;
+            seek(frame > 0 ? frame - 1 : 0);
+            return true;
+        case '[':
+            seek(frame > 60 ? frame - 60 : 0);
+            return true;
+        case ']':
+            seek(frame + 60);
+            return true;
+        case '{':
+            seek(frame > 600 ? frame - 600 : 0);
+            return true;
+        case '}':
+            seek(frame + 600);
+            return true;
+        default:
+            if (c >= '0' && c <= '9') {
+                seek(frames * size_t(c - '0') / 10);
+                return true;
+            }
+            return false;
+    }
+}
+
+uint16_t Replay::rows() const {
+    // the panels below show the frame
+    return 1;
+}
+
+uint16_t Replay::print(bool newline) {
+    uint16_t count = 0;
+    char when[32] = "-";
+    if (!streaming || stream.frames > 0) {
+        time_t t = time_t((streaming ? stream.reader.decoded_ms() : reader.time_ms(frame)) / 1000);
+        tm local{};
+        localtime_r(&t, &local);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    if (streaming) {
+        console.inverseln("  [LIVE] %s  %s  %s", path, when, stream.status());
+    } else {
+        console.inverseln("  [REPLAY] %s  %s  %zu/%zu  %s", path, when, frame + 1, reader.frames(),
+                          paused ? "paused (space, ,/. step, []{} 0-9 seek)" : "playing");
+    }
+    count++;
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Replay replay;
@@ -0,0 +1,96 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_REPLAY_H
+#define CCTOP_REPLAY_H
+
+#include "../lib/FrameStream.h"
+#include "../lib/Recording.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// frames decoded into history() before the one shown, for the graphs
+const size_t REPLAY_HISTORY = 1024;
+
+//
+// --replay: plays a recording through the usual panels in place of the
+// collectors.  The graphs draw from history(), which is filled from the
+// recording, and the other panels from the frame shown (load_panels());
+// this panel has the position.
+//
+// Space pauses, , and . step a frame, [ and ] skip 60 frames, { and }
+// 600, and 0-9 jump to that tenth of the recording.
+//
+// -c plays the frames a cctop -d daemon or agent sends the same way, as
+// they arrive, so a viewer samples nothing itself.  If the daemon goes
+// away the viewer keeps the last frame and tries again on every tick.
+//
+class Replay {
+public:
+    bool active() const { return opened; }
+
+    // watching a daemon rather than a recording
+    bool live() const { return streaming; }
+
+    // exits with a message if path isn't a recording
+    void open(const char *path);
+
+    // exits with a message if there's no daemon at address; shown() is called whenever there's news
+    void connect(const char *address, std::function<void()> shown);
+
+    // the timer: on to the next frame unless paused
+    void tick();
+
+    // true if c was a replay key
+    bool key(int c);
+
+public:
+    uint16_t rows() const;
+
+    uint16_t print(bool newline);
+
+protected:
+    RecordingReader reader;
+    const char *path{nullptr};
+    bool opened{false}, paused{false};
+    size_t frame{0};
+
+    // show frame n, history() and all
+    void seek(size_t n);
+
+    // the frame just read goes into history()
+    void show();
+
+    // -c
+    bool streaming{false};
+    FrameStream stream;
+    std::function<void()> on_frame;
+};
+
+// the frame last read goes into history() as one sample
+void load_history(const RecordingReader &reader);
+
+// the frame last read goes into the CPU, memory, disk, filesystem, network
+// and process panels in place of what their collectors read
+void load_panels(const RecordingReader &reader);
+
+extern Replay replay;
+
+#endif //CCTOP_REPLAY_H
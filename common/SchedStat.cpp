@@ -0,0 +1,208 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "SchedStat.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// wait (ms per second) thresholds for the history levels; waits matter long
+// before they add up to a whole CPU, so the scale is roughly logarithmic.
+static const double wait_levels[] = {1, 5, 10, 25, 50, 100, 250};
+
+int SchedStat::wait_level(double ms) {
+    if (!(ms >= 0)) {
+        // no data (or NaN, a gap in the history)
+        return -1;
+    }
+    int level = 0;
+    for (double threshold: wait_levels) {
+        if (ms < threshold) {
+            break;
+        }
+        level++;
+    }
+    return level;
+}
+
+// run queue wait history of cpu, or of the total if cpu is -1
+static std::string series_name(int cpu) {
+    return cpu < 0 ? "sched/CPU/wait" : "sched/CPU" + std::to_string(cpu) + "/wait";
+}
+
+void CPUSchedStats::diff(CPUSchedStats *newer, CPUSchedStats *older) {
+    this->run_ns = newer->run_ns - older->run_ns;
+    this->wait_ns = newer->wait_ns - older->wait_ns;
+    this->timeslices = newer->timeslices - older->timeslices;
+    this->seen = newer->seen && older->seen;
+}
+
+SchedStat::SchedStat(const char *path) {
+    file = new SysFile(path);
+    read(current);
+    last = current;
+    delta.resize(current.size());
+}
+
+SchedStat::~SchedStat() {
+    delete file;
+    file = nullptr;
+}
+
+void SchedStat::read(std::vector<CPUSchedStats> &v) {
+    const char *p = file->read();
+    if (!p) {
+        return;
+    }
+    for (auto &cpu: v) {
+        cpu.seen = false;
+    }
+    // only the cpuN lines matter; domainN lines follow each of them
+    for (; *p; p++) {
+        if (p[0] == 'c' && p[1] == 'p' && p[2] == 'u' && p[3] >= '0' && p[3] <= '9') {
+            char *end;
+            unsigned long id = strtoul(&p[3], &end, 10);
+            uint64_t fields[9]{};
+            for (uint64_t &field: fields) {
+                field = strtoull(end, &end, 10);
+            }
+            if (id >= v.size()) {
+                v.resize(id + 1);
+            }
+            v[id].run_ns = fields[6];
+            v[id].wait_ns = fields[7];
+            v[id].timeslices = fields[8];
+            v[id].seen = true;
+            p = end;
+        }
+        p = strchr(p, '\n');
+        if (!p) {
+            break;
+        }
+    }
+}
+
+void SchedStat::update() {
+    if (!file->ok()) {
+        return;
+    }
+    std::swap(last, current);
+    current = last;
+    interval.stamp();
+    read(current);
+    size_t n = current.size();
+    last.resize(n);
+    delta.resize(n);
+
+    total = CPUSchedStats();
+    int online = 0;
+    for (size_t i = 0; i < n; i++) {
+        delta[i].diff(&current[i], &last[i]);
+        if (!delta[i].seen) {
+            // offline, or just came online
+            delta[i] = CPUSchedStats();
+            history().series(series_name(int(i)))->append(HISTORY_GAP);
+            continue;
+        }
+        history().series(series_name(int(i)))->append(float(interval.per_second(double(delta[i].wait_ns)) / 1e6));
+        total.run_ns += delta[i].run_ns;
+        total.wait_ns += delta[i].wait_ns;
+        total.timeslices += delta[i].timeslices;
+        online++;
+    }
+    total.seen = online > 0;
+    history().series(series_name(-1))->append(
+            online ? float(interval.per_second(double(total.wait_ns)) / 1e6 / online) : HISTORY_GAP);
+}
+
+double SchedStat::wait_ms(int cpu) const {
+    const CPUSchedStats *s = cpu < 0 ? &total : cpu < int(delta.size()) ? &delta[cpu] : nullptr;
+    if (!s || !s->seen) {
+        return -1;
+    }
+    return interval.per_second(double(s->wait_ns)) / 1e6;
+}
+
+int64_t SchedStat::timeslices(int cpu) const {
+    const CPUSchedStats *s = cpu < 0 ? &total : cpu < int(delta.size()) ? &delta[cpu] : nullptr;
+    if (!s || !s->seen) {
+        return -1;
+    }
+    return int64_t(interval.per_second(double(s->timeslices)));
+}
+
+const Series *SchedStat::wait_history(int cpu) const {
+    return history().find(series_name(cpu));
+}
+
+bool SchedStat::has_process_stats() {
+    static int has = -1;
+    if (has < 0) {
+        has = SysFile::exists("/proc/self/schedstat") ? 1 : 0;
+    }
+    return has == 1;
+}
+
+// read a small /proc/[pid] file into buf; these come and go with the process,
+// so they can't be kept open like the per-cpu ones.
+static ssize_t read_proc(int pid, const char *name, char *buf, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n >= 0) {
+        buf[n] = '\0';
+    }
+    return n;
+}
+
+static int64_t status_field(const char *status, const char *field) {
+    const char *p = strstr(status, field);
+    if (!p) {
+        return -1;
+    }
+    return strtoll(p + strlen(field), nullptr, 10);
+}
+
+bool SchedStat::read_process(int pid, ProcessSchedStats *stats) {
+    char buf[4096];
+    if (read_proc(pid, "schedstat", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+    char *p;
+    stats->run_ns = strtoll(buf, &p, 10);
+    stats->wait_ns = strtoll(p, &p, 10);
+    stats->timeslices = strtoll(p, &p, 10);
+
+    if (read_proc(pid, "status", buf, sizeof(buf)) > 0) {
+        // voluntary_ctxt_switches is a suffix of nonvoluntary_ctxt_switches,
+        // so look for it at the start of a line
+        stats->voluntary_csw = status_field(buf, "\nvoluntary_ctxt_switches:");
+        stats->involuntary_csw = status_field(buf, "nonvoluntary_ctxt_switches:");
+    }
+    return true;
+}
+
+SchedStat schedstat;
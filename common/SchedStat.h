@@ -0,0 +1,102 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SCHEDSTAT_H
+#define CCTOP_SCHEDSTAT_H
+
+#include "../lib/Clock.h"
+#include "../lib/History.h"
+#include "../lib/SysFile.h"
+#include <cstdint>
+#include <vector>
+
+// samples of wait history shown per CPU
+const int SCHED_HISTORY_SIZE = 10;
+
+//
+// Run queue statistics for one CPU, from the cpuN lines of /proc/schedstat:
+//
+//   cpuN yld 0 sched goidle ttwu ttwu_local run_ns wait_ns timeslices
+//
+// wait_ns is time tasks spent runnable but waiting for this CPU, which is
+// the saturation signal that utilization can't give you: a core at 100% with
+// no wait is busy, one with seconds of wait per second is oversubscribed.
+//
+struct CPUSchedStats {
+    uint64_t run_ns{}, wait_ns{}, timeslices{};
+    bool seen{false};
+
+    void diff(CPUSchedStats *newer, CPUSchedStats *older);
+};
+
+//
+// Scheduler statistics for one process, from /proc/[pid]/schedstat
+// (run_ns wait_ns timeslices) and the *ctxt_switches lines of
+// /proc/[pid]/status.  -1 means not available.
+//
+struct ProcessSchedStats {
+    int64_t run_ns{-1}, wait_ns{-1}, timeslices{-1};
+    int64_t voluntary_csw{-1}, involuntary_csw{-1};
+};
+
+class SchedStat {
+public:
+    // index is cpu number, total is the sum over all cpus
+    std::vector<CPUSchedStats> last, current, delta;
+    CPUSchedStats total;
+    Interval interval; // between the last two reads
+
+public:
+    explicit SchedStat(const char *path = "/proc/schedstat");
+
+    ~SchedStat();
+
+public:
+    bool ok() const { return file->ok() && !current.empty(); }
+
+    void update();
+
+    // run queue wait during the last interval, in ms per second (-1 if none)
+    double wait_ms(int cpu) const;
+
+    // timeslices run per second during the last interval (-1 if none)
+    int64_t timeslices(int cpu) const;
+
+    // wait history (ms per second) for cpu, or for the total if cpu is -1;
+    // nullptr if there's none
+    const Series *wait_history(int cpu) const;
+
+    // 0-7 for wait_ms, -1 for no data
+    static int wait_level(double ms);
+
+public:
+    // true if this kernel has /proc/[pid]/schedstat
+    static bool has_process_stats();
+
+    static bool read_process(int pid, ProcessSchedStats *stats);
+
+protected:
+    SysFile *file;
+
+    void read(std::vector<CPUSchedStats> &v);
+};
+
+extern SchedStat schedstat;
+
+#endif //CCTOP_SCHEDSTAT_H
@@ -0,0 +1,305 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "../cctop.h"
+#include "Sensors.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/resource.h>
+
+static const char *CPU_DIR = "/sys/devices/system/cpu";
+static const char *HWMON_DIR = "/sys/class/hwmon";
+static const char *THERMAL_DIR = "/sys/class/thermal";
+
+// hwmon drivers that report CPU package temperatures
+static const char *cpu_hwmon_drivers[] = {
+        "coretemp", // Intel, one "Package id N" sensor per package
+        "k10temp",  // AMD, Tctl/Tdie
+        "zenpower",
+        "cpu_thermal", // Raspberry Pi and other ARM SoCs
+        nullptr,
+};
+
+// returns N for names like prefixN, or -1
+static int suffix_number(const char *name, const char *prefix) {
+    size_t len = strlen(prefix);
+    if (strncmp(name, prefix, len) || !isdigit(name[len])) {
+        return -1;
+    }
+    for (const char *p = &name[len]; *p; p++) {
+        if (!isdigit(*p)) {
+            return -1;
+        }
+    }
+    return atoi(&name[len]);
+}
+
+// We keep a couple of files open per core; big hosts can run past the default
+// soft limit of 1024 descriptors, so raise it toward the hard limit.
+static void reserve_descriptors(rlim_t needed) {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= needed) {
+        return;
+    }
+    limit.rlim_cur = limit.rlim_max == RLIM_INFINITY || limit.rlim_max > needed ? needed : limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+Sensors::Sensors() {
+    discover_cores();
+    discover_hwmon();
+    if (packages.empty()) {
+        discover_thermal_zones();
+    }
+    update();
+}
+
+Sensors::~Sensors() {
+    for (auto *core: cores) {
+        if (!core) {
+            continue;
+        }
+        delete core->frequency;
+        delete core->throttle;
+        delete core;
+    }
+    cores.clear();
+    for (auto *package: packages) {
+        delete package->input;
+        delete package;
+    }
+    packages.clear();
+}
+
+void Sensors::discover_cores() {
+    DIR *dir = opendir(CPU_DIR);
+    if (!dir) {
+        return;
+    }
+    std::vector<int> ids;
+    while (dirent *entry = readdir(dir)) {
+        int id = suffix_number(entry->d_name, "cpu");
+        if (id >= 0) {
+            ids.push_back(id);
+        }
+    }
+    closedir(dir);
+
+    reserve_descriptors(ids.size() * 2 + 256);
+
+    char path[256];
+    for (int id: ids) {
+        if (id >= int(cores.size())) {
+            cores.resize(id + 1, nullptr);
+        }
+        auto *core = cores[id] = new CoreSensors;
+
+        snprintf(path, sizeof(path), "%s/cpu%d/cpufreq/scaling_cur_freq", CPU_DIR, id);
+        if (SysFile::exists(path)) {
+            core->frequency = new SysFile(path);
+            has_frequency |= core->frequency->ok();
+        }
+        snprintf(path, sizeof(path), "%s/cpu%d/thermal_throttle/core_throttle_count", CPU_DIR, id);
+        if (SysFile::exists(path)) {
+            core->throttle = new SysFile(path);
+            has_throttle |= core->throttle->ok();
+        }
+    }
+}
+
+void Sensors::discover_hwmon() {
+    DIR *dir = opendir(HWMON_DIR);
+    if (!dir) {
+        return;
+    }
+    char path[512], name[64], label[64];
+    while (dirent *entry = readdir(dir)) {
+        if (suffix_number(entry->d_name, "hwmon") < 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s/name", HWMON_DIR, entry->d_name);
+        if (!SysFile::read_string(path, name, sizeof(name))) {
+            continue;
+        }
+        bool cpu = false;
+        for (const char **driver = cpu_hwmon_drivers; *driver; driver++) {
+            if (!strcmp(name, *driver)) {
+                cpu = true;
+                break;
+            }
+        }
+        if (!cpu) {
+            continue;
+        }
+
+        // coretemp has one labelled sensor per package plus one per core; AMD
+        // drivers have one per package (Tctl, or Tdie when it is offset).
+        // Anything else, we take temp1.
+        bool recorded = false;
+        int found = -1;
+        for (int n = 1; n < 64; n++) {
+            snprintf(path, sizeof(path), "%s/%s/temp%d_label", HWMON_DIR, entry->d_name, n);
+            if (!SysFile::read_string(path, label, sizeof(label))) {
+                continue;
+            }
+            if (!strncmp(label, "Package id ", 11)) {
+                snprintf(path, sizeof(path), "%s/%s/temp%d_input", HWMON_DIR, entry->d_name, n);
+                auto *package = new PackageTemperature;
+                package->label = "Package " + std::string(&label[11]);
+                package->input = new SysFile(path);
+                packages.push_back(package);
+                recorded = true;
+            } else if (!strcmp(label, "Tdie") || (!strcmp(label, "Tctl") && found < 0)) {
+                found = n;
+            }
+        }
+        if (recorded) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s/temp%d_input", HWMON_DIR, entry->d_name, found > 0 ? found : 1);
+        if (!SysFile::exists(path)) {
+            continue;
+        }
+        auto *package = new PackageTemperature;
+        package->label = "Package " + std::to_string(packages.size());
+        package->input = new SysFile(path);
+        packages.push_back(package);
+    }
+    closedir(dir);
+}
+
+void Sensors::discover_thermal_zones() {
+    DIR *dir = opendir(THERMAL_DIR);
+    if (!dir) {
+        return;
+    }
+    char path[512], type[64];
+    while (dirent *entry = readdir(dir)) {
+        if (suffix_number(entry->d_name, "thermal_zone") < 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s/type", THERMAL_DIR, entry->d_name);
+        if (!SysFile::read_string(path, type, sizeof(type))) {
+            continue;
+        }
+        if (strcmp(type, "x86_pkg_temp") != 0 && !strstr(type, "cpu")) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s/temp", THERMAL_DIR, entry->d_name);
+        auto *package = new PackageTemperature;
+        package->label = strcmp(type, "x86_pkg_temp") ? std::string(type)
+                                                       : "Package " + std::to_string(packages.size());
+        package->input = new SysFile(path);
+        packages.push_back(package);
+    }
+    closedir(dir);
+}
+
+void Sensors::update() {
+    interval.stamp();
+    for (auto *core: cores) {
+        if (!core) {
+            continue;
+        }
+        int64_t value;
+        if (core->frequency && core->frequency->read_long(&value)) {
+            core->mhz = value / 1000; // kHz
+        } else {
+            core->mhz = -1;
+        }
+        if (core->throttle && core->throttle->read_long(&value)) {
+            core->throttle_delta = core->throttle_total < 0 ? 0 : value - core->throttle_total;
+            core->throttle_total = value;
+        }
+    }
+    for (auto *package: packages) {
+        int64_t value;
+        if (package->input->read_long(&value)) {
+            package->celsius = double(value) / double(package->divisor);
+        } else {
+            package->celsius = -1;
+        }
+    }
+}
+
+int64_t Sensors::frequency(int core) const {
+    if (core >= 0) {
+        if (core >= int(cores.size()) || !cores[core]) {
+            return -1;
+        }
+        return cores[core]->mhz;
+    }
+    int64_t total = 0, count = 0;
+    for (auto *c: cores) {
+        if (c && c->mhz >= 0) {
+            total += c->mhz;
+            count++;
+        }
+    }
+    return count ? total / count : -1;
+}
+
+int64_t Sensors::throttles(int core) const {
+    if (core >= 0) {
+        if (core >= int(cores.size()) || !cores[core] || cores[core]->throttle_total < 0) {
+            return -1;
+        }
+        return std::llround(interval.per_second(double(cores[core]->throttle_delta)));
+    }
+    int64_t total = 0;
+    bool any = false;
+    for (auto *c: cores) {
+        if (c && c->throttle_total >= 0) {
+            total += c->throttle_delta;
+            any = true;
+        }
+    }
+    return any ? std::llround(interval.per_second(double(total))) : -1;
+}
+
+uint16_t Sensors::print() {
+    if (packages.empty()) {
+        return 0;
+    }
+    console.print("  %-6s ", "Temp");
+    for (auto *package: packages) {
+        console.mode_bold(true);
+        console.print(" %s ", package->label.c_str());
+        console.mode_clear();
+        if (package->celsius < 0) {
+            console.print("%5s", "-");
+            continue;
+        }
+        if (package->celsius >= 90) {
+            console.fg_red();
+            console.mode_bold();
+        } else if (package->celsius >= 75) {
+            console.fg_yellow();
+        }
+        console.print("%3.0f°C", package->celsius);
+        console.mode_clear();
+    }
+    console.newline();
+    return 1;
+}
+
+Sensors sensors;
@@ -0,0 +1,94 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SENSORS_H
+#define CCTOP_SENSORS_H
+
+#include "../lib/Clock.h"
+#include "../lib/SysFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Per core clock frequency and thermal throttle counts, and per package
+// temperatures, from sysfs:
+//
+//   /sys/devices/system/cpu/cpuN/cpufreq/scaling_cur_freq
+//   /sys/devices/system/cpu/cpuN/thermal_throttle/core_throttle_count
+//   /sys/class/hwmon/hwmonN/tempM_input (coretemp, k10temp, ...)
+//   /sys/class/thermal/thermal_zoneN/temp (fallback)
+//
+// The files are discovered once and kept open.  Cores, drivers or platforms
+// (MacOS) that don't expose a file just report "not available" and the CPU
+// panel leaves the column out or blank.
+//
+struct CoreSensors {
+    SysFile *frequency{nullptr};
+    SysFile *throttle{nullptr};
+    int64_t mhz{-1};
+    int64_t throttle_total{-1}, throttle_delta{0};
+};
+
+struct PackageTemperature {
+    std::string label;
+    SysFile *input{nullptr};
+    int64_t divisor{1000}; // millidegrees
+    double celsius{-1};
+};
+
+class Sensors {
+public:
+    bool has_frequency{false}, has_throttle{false};
+    std::vector<CoreSensors *> cores;
+    std::vector<PackageTemperature *> packages;
+    Interval interval; // between the last two updates
+
+public:
+    Sensors();
+
+    ~Sensors();
+
+protected:
+    void discover_cores();
+
+    void discover_hwmon();
+
+    void discover_thermal_zones();
+
+public:
+    void update();
+
+    // current frequency of core in MHz, or average across cores if core is -1.
+    // returns -1 if not available.
+    int64_t frequency(int core) const;
+
+    // thermal throttle events per second during the last interval for core,
+    // or total across cores if core is -1.  Returns -1 if not available.
+    int64_t throttles(int core) const;
+
+    // print package temperatures as one line (if there are any), return # lines printed
+    uint16_t print();
+
+    uint16_t rows() const { return packages.empty() ? 0 : 1; }
+};
+
+extern Sensors sensors;
+
+#endif //CCTOP_SENSORS_H
@@ -0,0 +1,401 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Alerts.h"
+#include "Console.h"
+#include "Format.h"
+#include "History.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <map>
+#include <spawn.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <syslog.h>
+#include <unistd.h>
+
+extern char **environ;
+
+static const char *OP_NAMES[] = {">", ">=", "<", "<="};
+
+// "30", "30s", "5m" or "1h" in ns; false if it isn't one of those
+static bool parse_duration(const std::string &s, uint64_t &ns) {
+    char *end;
+    double n = strtod(s.c_str(), &end);
+    if (end == s.c_str() || n < 0) {
+        return false;
+    }
+    switch (*end) {
+        case '\0':
+        case 's':
+            break;
+        case 'm':
+            n *= 60;
+            break;
+        case 'h':
+            n *= 60 * 60;
+            break;
+        default:
+            return false;
+    }
+    if (*end && end[1]) {
+        return false;
+    }
+    ns = uint64_t(n * 1e9);
+    return true;
+}
+
+static bool parse_number(const std::string &s, float &value) {
+    char *end;
+    value = strtof(s.c_str(), &end);
+    return end != s.c_str() && !*end && std::isfinite(value);
+}
+
+// "2026-10-19 14:03:07"
+static void format_time(char *out, size_t size, uint64_t time_ns) {
+    time_t t = time_t(time_ns / 1000000000);
+    tm local{};
+    localtime_r(&t, &local);
+    strftime(out, size, "%Y-%m-%d %H:%M:%S", &local);
+}
+
+Alerts::~Alerts() {
+    if (log >= 0) {
+        close(log);
+    }
+}
+
+bool Alerts::open(const char *path, const char *log_path, const char *command, std::string &error) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    char line[1024];
+    int number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        number++;
+        std::string text = line;
+        text = text.substr(0, text.find('#'));
+        Rule rule;
+        size_t colon = text.find(':');
+        if (colon != std::string::npos) {
+            rule.name = text.substr(0, colon);
+            text = text.substr(colon + 1);
+        }
+        std::istringstream in(text);
+        std::string series, op, threshold, word, value;
+        if (!(in >> series)) {
+            // blank
+            continue;
+        }
+        ok = false;
+        in >> op >> threshold;
+        if (series.size() > 6 && !series.compare(0, 5, "rate(") && series.back() == ')') {
+            rule.rate = true;
+            rule.series = series.substr(5, series.size() - 6);
+        } else {
+            rule.series = series;
+        }
+        size_t o = 0;
+        while (o < 4 && op != OP_NAMES[o]) {
+            o++;
+        }
+        if (o == 4) {
+            error = "expected >, >=, < or <= after " + series;
+        } else if (!parse_number(threshold, rule.threshold)) {
+            error = "expected a number after " + op;
+        } else {
+            rule.op = Op(o);
+            rule.clear = rule.threshold;
+            ok = true;
+        }
+        while (ok && in >> word) {
+            value.clear();
+            if (word == "for" && in >> value && parse_duration(value, rule.for_ns)) {
+                continue;
+            }
+            if (word == "clear" && in >> value && parse_number(value, rule.clear)) {
+                continue;
+            }
+            error = "expected for DURATION or clear NUMBER, not " + word + (value.empty() ? "" : " " + value);
+            ok = false;
+        }
+        if (!ok) {
+            error = std::string(path) + ":" + std::to_string(number) + ": " + error;
+            break;
+        }
+        // trimmed, or the rule itself if it has no name
+        size_t first = rule.name.find_first_not_of(" \t"), last = rule.name.find_last_not_of(" \t");
+        rule.name = first == std::string::npos ? series + " " + op + " " + threshold : rule.name.substr(first, last - first + 1);
+        rules.push_back(rule);
+    }
+    fclose(fp);
+    if (!ok) {
+        rules.clear();
+        return false;
+    }
+    if (rules.empty()) {
+        error = std::string(path) + ": no rules";
+        return false;
+    }
+    if (log_path) {
+        log = ::open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (log < 0) {
+            error = std::string(log_path) + ": " + strerror(errno);
+            rules.clear();
+            return false;
+        }
+    } else {
+        openlog("cctop", LOG_PID, LOG_USER);
+    }
+    if (command) {
+        hook = command;
+    }
+    return true;
+}
+
+void Alerts::bind(const Snapshot &snapshot) {
+    // what there was, by rule and series name, so a disk coming and going doesn't
+    // reset the rest; names, not pointers, since a new series can land where an old one was
+    std::map<std::pair<uint32_t, std::string>, size_t> was;
+    for (size_t i = 0; i < checks.size(); i++) {
+        was[{checks[i].rule, bound[checks[i].field]}] = i;
+    }
+    std::vector<Check> made;
+    std::vector<size_t> moved(checks.size(), SIZE_MAX); // old check to new
+    for (uint32_t r = 0; r < rules.size(); r++) {
+        const Rule &rule = rules[r];
+        bool pattern = rule.series.find_first_of("*?[") != std::string::npos;
+        for (uint32_t f = 0; f < snapshot.fields.size(); f++) {
+            const std::string &name = *snapshot.fields[f].name;
+            if (pattern ? fnmatch(rule.series.c_str(), name.c_str(), 0) != 0 : name != rule.series) {
+                continue;
+            }
+            auto it = was.find({r, name});
+            if (it != was.end()) {
+                moved[it->second] = made.size();
+                made.push_back(checks[it->second]);
+                made.back().field = f;
+            } else {
+                made.push_back({f, r, HISTORY_GAP, HISTORY_GAP, 0, 0, false});
+            }
+        }
+    }
+    // the ones still firing keep their order; one whose series has gone is over
+    std::vector<size_t> still;
+    for (size_t i: fired) {
+        if (moved[i] != SIZE_MAX) {
+            still.push_back(moved[i]);
+        } else {
+            report(checks[i], "cleared", snapshot.time_ns);
+        }
+    }
+    checks.swap(made);
+    fired.swap(still);
+    bound.clear();
+    for (const auto &field: snapshot.fields) {
+        bound.push_back(*field.name);
+    }
+}
+
+void Alerts::evaluate(const Snapshot &snapshot) {
+    bool same = bound.size() == snapshot.fields.size();
+    for (size_t i = 0; same && i < bound.size(); i++) {
+        same = bound[i] == *snapshot.fields[i].name;
+    }
+    if (!same) {
+        bind(snapshot);
+    }
+    // hooks that have finished
+    for (auto it = hooks.begin(); it != hooks.end();) {
+        if (waitpid(*it, nullptr, WNOHANG) != 0) {
+            it = hooks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    uint64_t now = snapshot.time_ns;
+    for (size_t i = 0; i < checks.size(); i++) {
+        Check &c = checks[i];
+        float v = snapshot.fields[c.field].value;
+        const Rule &rule = rules[c.rule];
+        if (rule.rate) {
+            float last = c.last;
+            uint64_t last_ns = c.last_ns;
+            c.last = v;
+            c.last_ns = std::isnan(v) ? 0 : now;
+            if (std::isnan(last) || !last_ns || now <= last_ns) {
+                continue;
+            }
+            v = float((double(v) - last) * 1e9 / double(now - last_ns));
+        }
+        if (std::isnan(v)) {
+            // no sample: as it was
+            continue;
+        }
+        c.value = v;
+        if (c.firing) {
+            bool cleared = rule.op == GT || rule.op == GE ? v < rule.clear : v > rule.clear;
+            if (cleared) {
+                c.firing = false;
+                c.since_ns = 0;
+                fired.erase(std::find(fired.begin(), fired.end(), i));
+                report(c, "cleared", now);
+            }
+            continue;
+        }
+        bool holds;
+        switch (rule.op) {
+            case GT:
+                holds = v > rule.threshold;
+                break;
+            case GE:
+                holds = v >= rule.threshold;
+                break;
+            case LT:
+                holds = v < rule.threshold;
+                break;
+            default:
+                holds = v <= rule.threshold;
+                break;
+        }
+        if (!holds) {
+            c.since_ns = 0;
+            continue;
+        }
+        if (!c.since_ns) {
+            c.since_ns = now;
+        }
+        if (now - c.since_ns >= rule.for_ns) {
+            c.firing = true;
+            fired.push_back(i);
+            report(c, "firing", now);
+        }
+    }
+}
+
+bool Alerts::firing(const std::string &prefix) const {
+    for (size_t i: fired) {
+        if (!bound[checks[i].field].compare(0, prefix.size(), prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Alerts::report(const Check &check, const char *state, uint64_t time_ns) {
+    const Rule &rule = rules[check.rule];
+    char when[32], value[FORMAT_FIELD_MAX], threshold[FORMAT_FIELD_MAX];
+    format_time(when, sizeof(when), time_ns);
+    value[format_plain(value, check.value)] = '\0';
+    threshold[format_plain(threshold, rule.threshold)] = '\0';
+    char line[1024];
+    int n = snprintf(line, sizeof(line), "%s %s %s: %s%s%s = %s (%s %s)\n", when, state, rule.name.c_str(),
+                     rule.rate ? "rate(" : "", bound[check.field].c_str(), rule.rate ? ")" : "", value,
+                     OP_NAMES[rule.op], threshold);
+    n = std::min(n, int(sizeof(line)) - 1);
+    if (log >= 0) {
+        if (::write(log, line, size_t(n)) < 0) {
+            // nowhere better to say so
+        }
+    } else {
+        syslog(LOG_WARNING, "%s", line + strlen(when) + 1);
+    }
+
+    if (hook.empty()) {
+        return;
+    }
+    if (hooks.size() >= ALERTS_MAX_HOOKS) {
+        return;
+    }
+    std::vector<std::string> env;
+    for (char **e = environ; *e; e++) {
+        if (strncmp(*e, "CCTOP_", 6) != 0) {
+            env.emplace_back(*e);
+        }
+    }
+    env.push_back("CCTOP_ALERT=" + rule.name);
+    env.push_back("CCTOP_SERIES=" + bound[check.field]);
+    env.push_back(std::string("CCTOP_VALUE=") + value);
+    env.push_back(std::string("CCTOP_STATE=") + state);
+    std::vector<char *> envp;
+    for (auto &e: env) {
+        envp.push_back(&e[0]);
+    }
+    envp.push_back(nullptr);
+    const char *argv[] = {"sh", "-c", hook.c_str(), nullptr};
+    // the event loop blocks (or ignores) these; the hook gets them back so ^C reaches it
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t none, defaults;
+    sigemptyset(&none);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGTERM);
+    sigaddset(&defaults, SIGWINCH);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    pid_t pid;
+    if (posix_spawn(&pid, "/bin/sh", nullptr, &attr, (char **) argv, envp.data()) == 0) {
+        hooks.push_back(pid);
+    }
+    posix_spawnattr_destroy(&attr);
+}
+
+uint16_t Alerts::rows() const {
+    return uint16_t(std::min(fired.size(), ALERTS_SHOWN) + (fired.size() > ALERTS_SHOWN ? 1 : 0));
+}
+
+uint16_t Alerts::print(bool newline) {
+    uint16_t count = 0;
+    for (size_t n = 0; n < fired.size() && n < ALERTS_SHOWN; n++) {
+        const Check &c = checks[fired[n]];
+        const Rule &rule = rules[c.rule];
+        char since[32], value[FORMAT_FIELD_MAX];
+        format_time(since, sizeof(since), c.since_ns);
+        value[format_plain(value, c.value)] = '\0';
+        console.mode_bold(true);
+        console.inverseln("  ALERT %s: %s = %s  since %s", rule.name.c_str(), bound[c.field].c_str(), value,
+                          since);
+        console.mode_clear();
+        count++;
+    }
+    if (fired.size() > ALERTS_SHOWN) {
+        console.println("  and %zu more", fired.size() - ALERTS_SHOWN);
+        count++;
+    }
+    if (newline) {
+        console.newline();
+        count++;
+    }
+    return count;
+}
+
+Alerts alerts;
@@ -0,0 +1,139 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_ALERTS_H
+#define CCTOP_ALERTS_H
+
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// firing alerts listed at the top of the screen; the rest are counted
+const size_t ALERTS_SHOWN = 5;
+
+// hooks left running at once; a firing while that many are still going isn't passed on
+const size_t ALERTS_MAX_HOOKS = 8;
+
+//
+// -a: threshold and rate-of-change rules checked against every update.
+// A rules file has one rule a line ('#' starts a comment):
+//
+//   [name:] SERIES|rate(SERIES) OP NUMBER [for DURATION] [clear NUMBER]
+//
+// e.g.
+//
+//   cpu busy: cpu/CPU > 90 for 30s clear 75
+//   disk/*/ops > 500 for 10s
+//   swapping: rate(swap/used) > 1048576
+//
+// OP is >, >=, < or <=; DURATION is seconds, or N followed by s, m or h.
+// SERIES is a name from the snapshot (the ones -f ndjson writes) or an
+// fnmatch() pattern, which makes the rule apply to each matching series
+// on its own.  rate() is the change per second since the last update.
+// A rule fires once its condition has held for DURATION (at once if
+// there's none), and clears when the value gets back past the clear
+// NUMBER (the threshold if there's none), so one hovering around the line
+// doesn't flap.
+//
+// The rules are compiled into a flat array of checks, one per rule and
+// series, each holding the index of its value in the snapshot and its
+// own state; an update is a single pass over that array.  The checks are
+// bound again only when the set of series changes (a disk comes or goes).
+//
+// Firing and clearing are logged (to --alert-log, or syslog) and passed to
+// --alert-exec, run with /bin/sh -c and CCTOP_ALERT, CCTOP_SERIES,
+// CCTOP_VALUE and CCTOP_STATE (firing or cleared) in its environment.
+// One whose series goes away (the disk is unplugged) clears with its last
+// value.
+//
+class Alerts {
+public:
+    Alerts() = default;
+
+    Alerts(const Alerts &) = delete;
+
+    Alerts &operator=(const Alerts &) = delete;
+
+    ~Alerts();
+
+public:
+    // read the rules; false with a message in error if they won't do
+    bool open(const char *rules, const char *log, const char *hook, std::string &error);
+
+    bool active() const { return !rules.empty(); }
+
+    // check every rule against this update
+    void evaluate(const Snapshot &snapshot);
+
+    // is anything firing for a series whose name starts with prefix
+    bool firing(const std::string &prefix) const;
+
+public:
+    uint16_t rows() const;
+
+    uint16_t print(bool newline);
+
+protected:
+    enum Op : uint8_t {
+        GT,
+        GE,
+        LT,
+        LE,
+    };
+
+    struct Rule {
+        std::string name, series; // series may be a pattern
+        bool rate{false};
+        Op op{GT};
+        float threshold{}, clear{};
+        uint64_t for_ns{0};
+    };
+
+    // one rule applied to one series
+    struct Check {
+        uint32_t field;  // index in the snapshot, and in bound
+        uint32_t rule;
+        float value;     // what was compared last
+        float last;      // rate(): the value last time
+        uint64_t last_ns;
+        uint64_t since_ns; // when the condition started holding, 0 if it doesn't
+        bool firing;
+    };
+
+    std::vector<Rule> rules;
+    std::vector<Check> checks;
+    std::vector<std::string> bound; // the snapshot's names when checks were made, by field
+    std::vector<size_t> fired;      // checks that are firing, oldest first
+    int log{-1};                    // -1 for syslog
+    std::string hook;
+    std::vector<pid_t> hooks;       // still running
+
+    // make the checks for the snapshot's series, keeping the state of ones that were there
+    void bind(const Snapshot &snapshot);
+
+    // firing or cleared
+    void report(const Check &check, const char *state, uint64_t time_ns);
+};
+
+extern Alerts alerts;
+
+#endif //CCTOP_ALERTS_H
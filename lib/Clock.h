@@ -0,0 +1,70 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_CLOCK_H
+#define CCTOP_CLOCK_H
+
+#include <cstdint>
+#include <ctime>
+
+// nanoseconds on CLOCK_MONOTONIC, which doesn't jump when the wall clock is set
+inline uint64_t monotonic_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+// nanoseconds since the epoch, for timestamps that leave the process
+inline uint64_t realtime_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+//
+// When a collector took its last two samples.  Deltas are divided by the
+// time actually elapsed, not by an assumed one second tick, so a late tick
+// (or an extra sample) still gives true per second rates.
+//
+struct Interval {
+    uint64_t last_ns{}, current_ns{};
+
+    // call as the counters are read
+    void stamp() {
+        last_ns = current_ns;
+        current_ns = monotonic_ns();
+    }
+
+    // 0 until there are two samples
+    double seconds() const { return last_ns ? double(current_ns - last_ns) / 1e9 : 0; }
+
+    double per_second(double delta) const {
+        double s = seconds();
+        return s > 0 ? delta / s : 0;
+    }
+
+    // exactly a second, so per_second() passes figures that are already
+    // rates (a recording's) through as they are
+    void unit() {
+        last_ns = 1;
+        current_ns = 1 + 1000000000ull;
+    }
+};
+
+#endif //CCTOP_CLOCK_H
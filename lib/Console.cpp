@@ -27,8 +27,8 @@
 
 #include "../cctop.h"
 #include "Console.h"
-#include <ncurses.h>
 #include "Options.h"
+#include <cctype>
 #include <cwchar>
 #include <csignal>
 #include <cstdarg>
@@ -36,18 +36,13 @@
 #include <cstdio>
 #include <unistd.h>
 
+#include <sys/ioctl.h>
 #include <termios.h>
 
-#ifdef USE_NCURSES
-
-
-#else
+#ifndef USE_NCURSES
 
-#include <sys/select.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <fcntl.h>
-#include <ctime>
+#include <cerrno>
+#include <poll.h>
 
 #endif
 
@@ -57,52 +52,26 @@ const uint8_t ATTR_UNDERSCORE = 4;
 const uint8_t ATTR_BLINK = 5;
 const uint8_t ATTR_INVERSE = 7;
 
-#ifdef USE_NCURSES
-// colors
-const uint8_t FG_BLACK = COLOR_BLACK;
-const uint8_t FG_RED = COLOR_RED;
-const uint8_t FG_GREEN = COLOR_GREEN;
-const uint8_t FG_YELLOW = COLOR_YELLOW;
-const uint8_t FG_BLUE = COLOR_BLUE;
-const uint8_t FG_MAGENTA = COLOR_MAGENTA;
-const uint8_t FG_CYAN = COLOR_CYAN;
-const uint8_t FG_WHITE = COLOR_WHITE;
-const uint8_t BG_BLACK = COLOR_BLACK;
-const uint8_t BG_RED = COLOR_RED;
-const uint8_t BG_GREEN = COLOR_GREEN;
-const uint8_t BG_YELLOW = COLOR_YELLOW;
-const uint8_t BG_BLUE = COLOR_BLUE;
-const uint8_t BG_MAGENTA = COLOR_MAGENTA;
-const uint8_t BG_CYAN = COLOR_CYAN;
-const uint8_t BG_WHITE = COLOR_WHITE;
-
-const uint8_t DEFAULT_BACKGROUND = COLOR_BLACK;
-const uint8_t DEFAULT_FOREGROUND = COLOR_WHITE;
-
-#else
-const char ESC = 0x1b;
-
-// colors
-const uint8_t FG_BLACK = 30;
-const uint8_t FG_RED = 31;
-const uint8_t FG_GREEN = 32;
-const uint8_t FG_YELLOW = 33;
-const uint8_t FG_BLUE = 34;
-const uint8_t FG_MAGENTA = 35;
-const uint8_t FG_CYAN = 36;
-const uint8_t FG_WHITE = 37;
-const uint8_t BG_BLACK = 40;
-const uint8_t BG_RED = 41;
-const uint8_t BG_GREEN = 42;
-const uint8_t BG_YELLOW = 43;
-const uint8_t BG_BLUE = 44;
-const uint8_t BG_MAGENTA = 45;
-const uint8_t BG_CYAN = 46;
-const uint8_t BG_WHITE = 47;
+// colors, numbered as ANSI (30 + n foreground, 40 + n background) and curses do
+const uint8_t FG_BLACK = 0;
+const uint8_t FG_RED = 1;
+const uint8_t FG_GREEN = 2;
+const uint8_t FG_YELLOW = 3;
+const uint8_t FG_BLUE = 4;
+const uint8_t FG_MAGENTA = 5;
+const uint8_t FG_CYAN = 6;
+const uint8_t FG_WHITE = 7;
+const uint8_t BG_BLACK = 0;
+const uint8_t BG_RED = 1;
+const uint8_t BG_GREEN = 2;
+const uint8_t BG_YELLOW = 3;
+const uint8_t BG_BLUE = 4;
+const uint8_t BG_MAGENTA = 5;
+const uint8_t BG_CYAN = 6;
+const uint8_t BG_WHITE = 7;
 
 const uint8_t DEFAULT_BACKGROUND = BG_BLACK;
 const uint8_t DEFAULT_FOREGROUND = FG_WHITE;
-#endif
 
 #ifdef USE_NCURSES
 #if 0
@@ -192,58 +161,117 @@ static int alloc_color_pair(uint8_t fg, uint8_t bg) {
 #endif
 #endif
 
-static long millis() {
-    timeval time{};
-    gettimeofday(&time, nullptr);
-    return (time.tv_sec * 1000) + (time.tv_usec / 1000);
+uint16_t Console::cursor_row() {
+    current_row = screen.row;
+    return current_row;
 }
 
-// window size/change handling
-void resize_handler(int sig) {
-    if (sig == SIGWINCH) {
-        console.resize();
-    } else {
-        printf("signal %d\n", sig);
-    }
+uint16_t Console::cursor_column() {
+    current_column = screen.column;
+    return current_column;
 }
 
-void exit_handler(int sig) {
-    console.cleanup();
-    if (sig == SIGINT) {
-        printf("^C\n");
-    } else if (sig == SIGTERM) {
-        printf("KILLED\n");
+#ifdef USE_NCURSES
+static int color_pair(uint8_t fg, uint8_t bg) {
+    static short pairs[8][8];
+    static bool initialized = false;
+    if (!initialized) {
+        for (auto &row: pairs) {
+            for (short &pair: row) {
+                pair = -1;
+            }
+        }
+        initialized = true;
     }
-    exit(0);
+    short &pair = pairs[fg & 7][bg & 7];
+    if (pair < 0) {
+        int p = find_pair(fg & 7, bg & 7);
+        pair = short(p >= 0 ? p : alloc_pair(fg & 7, bg & 7));
+    }
+    return pair;
 }
 
-uint16_t Console::cursor_row() {
-#ifdef USE_NCURSES
-    current_row = getcury(stdscr);
-#endif
-    return current_row;
+static attr_t cell_attrs(const Cell &cell) {
+    attr_t a = A_NORMAL;
+    if (cell.attr & CELL_BOLD) {
+        a |= A_BOLD;
+    }
+    if (cell.attr & CELL_UNDERLINE) {
+        a |= A_UNDERLINE;
+    }
+    if (cell.attr & CELL_BLINK) {
+        a |= A_BLINK;
+    }
+    if (cell.attr & CELL_INVERSE) {
+        a |= A_REVERSE;
+    }
+    return a;
 }
 
-uint16_t Console::cursor_column() {
-#ifdef USE_NCURSES
-    current_column = getcury(stdscr);
-#endif
-    return current_column;
+// write a run of changed cells, one addnwstr per change of attributes
+static void put_cells(uint16_t r, uint16_t c, const Cell *cells, int n) {
+    wchar_t text[512];
+    move(r, c);
+    for (int i = 0; i < n;) {
+        const Cell &style = cells[i];
+        int len = 0;
+        for (; i < n && (cells[i].glyph == 0 || cells[i].same_style(style)) && len < 511; i++) {
+            if (cells[i].glyph) {
+                text[len++] = cells[i].glyph;
+            }
+        }
+        attr_set(cell_attrs(style), short((style.attr & CELL_COLOR) ? color_pair(style.fg, style.bg) : 0), nullptr);
+        addnwstr(text, len);
+    }
+    attrset(A_NORMAL);
 }
+#endif
 
 void Console::update() {
 #ifdef USE_NCURSES
+    if (!screen.is_valid()) {
+        ::clearok(stdscr, TRUE);
+        ::erase();
+    }
+    screen.flush(put_cells);
     refresh();
+#else
+    screen.render(output);
+    write_output();
 #endif
 }
 
+#ifndef USE_NCURSES
+// the whole frame (or escape sequence) goes out with a single write(2)
+void Console::write_output() {
+    const char *p = output.data();
+    size_t left = output.size();
+    while (left > 0) {
+        ssize_t n = ::write(STDOUT_FILENO, p, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        p += n;
+        left -= size_t(n);
+    }
+    output.clear();
+}
+#endif
+
 void Console::cleanup() {
+    if (!started) {
+        // never touched the terminal
+        return;
+    }
     tcsetattr(0, TCSANOW, &initial_termios);
     if (!aborting) {
 #ifndef USE_NCURSES
-        reset();
-        clear();
-        show_cursor(true);
+        // reset attributes, show the cursor and leave the alternate screen
+        output += "\x1b[0m\x1b[?25h\x1b[?1049l";
+        write_output();
 #else
         endwin();
 #endif
@@ -251,12 +279,23 @@ void Console::cleanup() {
     aborting = true;
 }
 
-Console::Console() {
+Console::Console() = default;
+
+void Console::start() {
+    if (started) {
+        return;
+    }
+    started = true;
     tcgetattr(0, &initial_termios);
 #ifdef USE_NCURSES
     initscr();
     start_color();
 //    xinit_color_pairs();
+#else
+    // draw on the alternate screen, so the shell's scrollback is left alone
+    output.reserve(64 * 1024);
+    output += "\x1b[?1049h";
+    write_output();
 #endif
     default_colors();
 
@@ -264,13 +303,6 @@ Console::Console() {
     resize();
     reset();
     clear();
-#ifndef USE_NCURSES
-    // install sigwinch handler (window resize signal)
-    signal(SIGWINCH, resize_handler);
-#endif
-    signal(SIGINT, exit_handler);
-    signal(SIGTERM, exit_handler);
-
 }
 
 Console::~Console() {
@@ -294,16 +326,31 @@ void Console::resize() {
     height = LINES;
 #else
     winsize size{0};
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &size);
-    width = 120;
-    height = 120;
-//    this->width = size.ws_col;
-//    this->height = size.ws_row;
-    clear();
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col && size.ws_row) {
+        width = size.ws_col;
+        height = size.ws_row;
+    } else {
+        // not a tty (or it won't say); fall back on the environment
+        const char *columns = getenv("COLUMNS"), *lines = getenv("LINES");
+        width = columns ? uint16_t(atoi(columns)) : 80;
+        height = lines ? uint16_t(atoi(lines)) : 24;
+    }
 #endif
+    screen.resize(width, height);
     clear();
 }
 
+void Console::resized() {
+#ifdef USE_NCURSES
+    // SIGWINCH goes to the event loop, so curses has to be told
+    winsize size{0};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col && size.ws_row) {
+        resizeterm(size.ws_row, size.ws_col);
+    }
+#endif
+    resize();
+}
+
 void Console::raw(bool on) {
 #ifdef USE_NCURSES
     ::raw();
@@ -315,79 +362,138 @@ void Console::raw(bool on) {
     if (on) {
         // disable buffering and echo and signals (^c, etc.)
         t.c_lflag &= ~(ICANON | ECHO | ISIG);
-        tcsetattr(0, TCSANOW, &t);
+        t.c_cc[VMIN] = 1;
+        t.c_cc[VTIME] = 0;
     } else {
         // enable buffering and echo and signals (^c, etc.)
         t.c_lflag |= (ICANON | ECHO | ISIG);
     }
+    tcsetattr(0, TCSANOW, &t);
 #endif
     raw_input = on;
 }
 
-bool Console::read_character(int *c, bool timeout) {
-    long now = millis(), when = now + options.read_timeout;
-    char cc = '\0';
-#ifndef USE_NCURSES
-    if (!timeout) {
-        read(0, &cc, 1);
-        *c = cc;
-        return true;
-    }
-    if (timeout) {
-        while (millis() < when) {
-            fd_set set;
-            FD_ZERO(&set);
-            FD_SET(0, &set);
-
-            timeval t{};
-            t.tv_sec = 0;
-            t.tv_usec = 100;
-
-            int ret = select(1, &set, nullptr, nullptr, &t);
-            switch (ret) {
-                case -1:
-                    // error occurred
-                    return false;
-                case 0:
-                    // timeout
-                    usleep(100);
-                    continue;
-                default:
-                    if (read(0, &cc, 1) == 1) {
-                        *c = int(cc);
-                        return true;
-                    }
-                    break;
-            }
-        }
+bool Console::read_character(int *c) {
+    // like getch(), show what has been drawn before waiting
+    update();
+#ifdef USE_NCURSES
+    ::timeout(-1);
+    int cc = getch();
+    if (cc == ERR) {
+        return false;
     }
+    *c = cc;
 #else
-    if (!timeout) {
-        cc = getch();
-        *c = (unsigned char)cc;
-        return true;
+    char cc;
+    if (read(0, &cc, 1) != 1) {
+        return false;
     }
+    *c = (unsigned char) cc;
+#endif
+    return true;
+}
 
-    ::timeout(500);
-
-    while (millis() < when) {
+bool Console::read_key(int *c) {
+#ifdef USE_NCURSES
+    // curses may already hold the rest of an escape sequence, so ask it
+    // rather than the descriptor
+    ::timeout(0);
+    for (;;) {
         int cc = getch();
         switch (cc) {
-            case 0:
             case ERR:
-                continue;
+                return false;
+            case 0:
             case KEY_RESIZE:
-                resize();
                 continue;
+            case KEY_UP:
+                *c = CONSOLE_KEY_UP;
+                return true;
+            case KEY_DOWN:
+                *c = CONSOLE_KEY_DOWN;
+                return true;
+            case KEY_PPAGE:
+                *c = CONSOLE_KEY_PAGE_UP;
+                return true;
+            case KEY_NPAGE:
+                *c = CONSOLE_KEY_PAGE_DOWN;
+                return true;
+            case KEY_HOME:
+                *c = CONSOLE_KEY_HOME;
+                return true;
+            case KEY_END:
+                *c = CONSOLE_KEY_END;
+                return true;
+            case KEY_BACKSPACE:
+                *c = 127;
+                return true;
+            case KEY_ENTER:
+                *c = '\n';
+                return true;
             default:
                 *c = cc;
                 return true;
         }
     }
+#else
+    pollfd p{0, POLLIN, 0};
+    char cc;
+    if (poll(&p, 1, 0) <= 0 || read(0, &cc, 1) != 1) {
+        return false;
+    }
+    *c = cc == 0x1b ? read_escape() : (unsigned char) cc;
+    return true;
 #endif
+}
 
-    return false;
+#ifndef USE_NCURSES
+// The rest of a cursor key's escape sequence (ESC [ A, ESC [ 5 ~, ESC O H...),
+// which the terminal sends all at once.  Anything else is just ESC.
+int Console::read_escape() {
+    char seq[8];
+    int n = 0;
+    pollfd p{0, POLLIN, 0};
+    while (n < int(sizeof(seq)) - 1 && poll(&p, 1, 0) > 0 && read(0, &seq[n], 1) == 1) {
+        char last = seq[n++];
+        if (n == 1 ? last != '[' && last != 'O' : last == '~' || isalpha((unsigned char) last)) {
+            break;
+        }
+    }
+    seq[n] = '\0';
+    if (n < 2 || (seq[0] != '[' && seq[0] != 'O')) {
+        return 0x1b;
+    }
+    switch (seq[n - 1]) {
+        case 'A':
+            return CONSOLE_KEY_UP;
+        case 'B':
+            return CONSOLE_KEY_DOWN;
+        case 'H':
+            return CONSOLE_KEY_HOME;
+        case 'F':
+            return CONSOLE_KEY_END;
+        case '~':
+            switch (atoi(&seq[1])) {
+                case 1:
+                case 7:
+                    return CONSOLE_KEY_HOME;
+                case 4:
+                case 8:
+                    return CONSOLE_KEY_END;
+                case 5:
+                    return CONSOLE_KEY_PAGE_UP;
+                case 6:
+                    return CONSOLE_KEY_PAGE_DOWN;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+    return 0x1b;
 }
+#endif
 
 void Console::show_cursor(bool on) {
 #ifdef USE_NCURSES
@@ -399,34 +505,31 @@ void Console::show_cursor(bool on) {
         cursor_hidden = true;
     }
 #else
-    if (on) {
-        printf("%c[?25h", ESC, stdout);
-        cursor_hidden = false;
-    } else {
-        printf("%c[?25l", ESC, stdout);
-        cursor_hidden = true;
-    }
-    fflush(stdout);
+    output += on ? "\x1b[?25h" : "\x1b[?25l";
+    cursor_hidden = !on;
+    write_output();
 #endif
 }
 
 /** @public **/
 void Console::clear(bool endOfScreen) {
-#ifdef USE_NCURSES
-    ::clear();
-#else
-    printf("%c[%dJ", ESC, endOfScreen ? 0 : 2);
-    fflush(stdout);
-#endif
+    if (endOfScreen) {
+        uint16_t row = screen.row;
+        screen.clear_eol();
+        for (uint16_t r = row + 1; r < height; r++) {
+            screen.move(r, 0);
+            screen.clear_eol();
+        }
+    } else {
+        screen.clear();
+    }
     moveTo(0, 0);
 }
 
 /** @public **/
 void Console::reset() {
-#ifdef USE_NCURSES
-    attrset(A_NORMAL);
-#else
     set_mode(ATTR_OFF, true);
+#ifndef USE_NCURSES
     background = foreground = 0;
     show_cursor(true);
 #endif
@@ -434,116 +537,67 @@ void Console::reset() {
 
 /** @public **/
 void Console::clear_eol() {
-#ifdef USE_NCURSES
-    clrtoeol();
-#else
-    printf("%c[0K", ESC);
-    fflush(stdout);
-#endif
+    screen.clear_eol();
 }
 
 /** @public **/
 void Console::moveTo(uint16_t r, uint16_t c) {
-#ifdef USE_NCURSES
-    move(r, c);
-#else
-    printf("%c[%d;%dH", ESC, row, col);
-    fflush(stdout);
-#endif
+    screen.move(r, c);
     current_row = r;
     current_column = c;
 }
 
+/** @public **/
+void Console::viewport(uint16_t top, uint16_t left, uint16_t w, uint16_t h) {
+    screen.viewport(top, left, w, h);
+    width = screen.view_width();
+    height = screen.view_height();
+    moveTo(0, 0);
+}
+
+/** @public **/
+void Console::fullscreen() {
+    viewport(0, 0, screen.width, screen.height);
+}
+
 /** @private */
 void Console::set_mode(uint8_t attr, bool on) {
-#ifdef USE_NCURSES
+    uint8_t bit = 0;
     switch (attr) {
         case ATTR_OFF:
-            if (on) {
-                attron(A_NORMAL);
-            } else {
-                attroff(A_NORMAL);
-            }
-            bold = underscore = blink = inverse = false;
-            break;
+            screen.pen.attr = 0;
+            bold = underscore = blink = inverse = concealed = false;
+            return;
         case ATTR_BOLD:
-            if (on) {
-                attron(A_BOLD);
-            } else {
-                attroff(A_BOLD);
-            }
+            bit = CELL_BOLD;
             bold = on;
             break;
         case ATTR_UNDERSCORE:
-            if (on) {
-                attron(A_UNDERLINE);
-            } else {
-                attroff(A_UNDERLINE);
-            }
+            bit = CELL_UNDERLINE;
             underscore = on;
             break;
         case ATTR_BLINK:
-            if (on) {
-                attron(A_BLINK);
-            } else {
-                attroff(A_BLINK);
-            }
+            bit = CELL_BLINK;
             blink = on;
             break;
         case ATTR_INVERSE:
-            if (on) {
-                attron(A_REVERSE);
-            } else {
-                attroff(A_REVERSE);
-            }
+            bit = CELL_INVERSE;
             inverse = on;
             break;
         default:
             // shouldn't get here
             break;
     }
-#else
     if (on) {
-        printf("%c[%dm", ESC, attr);
+        screen.pen.attr |= bit;
     } else {
-        printf("%c[=%dl", ESC, attr);
+        screen.pen.attr &= ~bit;
     }
-    fflush(stdout);
-    switch (attr) {
-        case ATTR_OFF:
-            bold = underscore = blink = inverse =
-            concealed = false;
-            show_cursor(!cursor_hidden);
-            break;
-        case ATTR_BOLD:
-            bold = on;
-            break;
-        case ATTR_UNDERSCORE:
-            underscore = on;
-            break;
-        case ATTR_BLINK:
-            blink = on;
-            break;
-        case ATTR_INVERSE:
-            inverse = on;
-            break;
-//        case ATTR_CONCEALED:
-//            concealed = on;
-//            break;
-        default:
-            break;
-    }
-#endif
 }
 
 void Console::mode_clear() {
-#ifdef USE_NCURSES
-//    default_colors();
-    attrset(A_NORMAL);
-#else
+    // also back to the terminal's colors, like attrset(A_NORMAL)
     set_mode(ATTR_OFF, true);
-    fflush(stdout);
-#endif
 }
 
 /** @public **/
@@ -561,37 +615,18 @@ void Console::mode_inverse(bool on) { set_mode(ATTR_INVERSE, on); }
 void Console::set_colors(uint8_t fg, uint8_t bg) {
     foreground = fg;
     background = bg;
-#ifdef USE_NCURSES
-    current_pair = find_pair(fg, bg);
-    if (current_pair != -1) {
-        attron(COLOR_PAIR(current_pair));
-    } else {
-        current_pair = alloc_pair(foreground, background);
-        attron(COLOR_PAIR(current_pair));
-    }
-#else
-    printf("%c[%dm", ESC, foreground);
-    printf("%c[%dm", ESC, background);
-#endif
+    screen.pen.fg = fg;
+    screen.pen.bg = bg;
+    screen.pen.attr |= CELL_COLOR;
 }
 
 /** @private */
 void Console::set_foreground(uint8_t color) {
-    foreground = color;
-#ifdef USE_NCURSES
-    set_colors(foreground, background);
-#else
-    printf("%c[%dm", ESC, foreground);
-#endif
+    set_colors(color, background);
 }
 
 void Console::set_background(uint8_t color) {
-    background = color;
-#ifdef USE_NCURSES
-    set_colors(foreground, background);
-#else
-    printf("%c[%dm", ESC, background);
-#endif
+    set_colors(foreground, color);
 }
 
 void Console::default_colors() {
@@ -721,13 +756,9 @@ void Console::print(const char *fmt, ...) {
     char buffer[1024];
 
     va_start(ap, fmt);
-    vsprintf(buffer, fmt, ap);
+    vsnprintf(buffer, sizeof(buffer), fmt, ap);
     va_end(ap);
-#ifdef USE_NCURSES
-    printw("%s", buffer);
-#else
-    printf("%s", buffer);
-#endif
+    screen.puts(buffer);
 }
 
 void Console::println(const char *fmt, ...) {
@@ -735,67 +766,36 @@ void Console::println(const char *fmt, ...) {
 
     char buffer[1024];
     va_start(ap, fmt);
-    vsprintf(buffer, fmt, ap);
+    vsnprintf(buffer, sizeof(buffer), fmt, ap);
     va_end(ap);
-#ifdef USE_NCURSES
-    printw("%s", buffer);
-#else
-    printf("%s", buffer);
-#endif
+    screen.puts(buffer);
     newline();
 }
 
 void Console::inverseln(const char *fmt, ...) {
-#ifdef USE_NCURSES
     char buffer[1024];
     va_list ap;
 
     va_start(ap, fmt);
-    vsprintf(buffer, fmt, ap);
+    vsnprintf(buffer, sizeof(buffer), fmt, ap);
     va_end(ap);
     console.mode_inverse(true);
-    printw("%s", buffer);
-    int len = this->width - strlen(buffer) - 1;
-    for (int i = 0; i < len; i++) {
-        printw(" ");
+    screen.puts(buffer);
+    while (screen.column < this->width - 1) {
+        screen.put(L' ');
     }
     console.mode_inverse(false);
-#else
-    va_list ap;
-
-    va_start(ap, fmt);
-//    console.mode_inverse(true);
-    console.bg_white();
-    console.fg_black();
-    vprintf(fmt, ap);
-    console.clear_eol();
-    va_end(ap);
-    fputs("\n", stdout);
-    console.mode_clear();
-    fflush(stdout);
-#endif
     newline();
 }
 
 void Console::wprintf(const wchar_t *fmt, ...) {
-#ifdef USE_NCURSES
     va_list ap;
 
     wchar_t buffer[1024];
     va_start(ap, fmt);
     vswprintf(buffer, 1024, fmt, ap);
     va_end(ap);
-    ::addwstr((wchar_t *) buffer);
-//    debug.printw(L"buffer: %ls\n", buffer);
-#else
-    va_list ap;
-
-    va_start(ap, fmt);
-    vwprintf(fmt, ap);
-    va_end(ap);
-    fflush(stdout);
-#endif
-
+    screen.putws(buffer);
 }
 
 void Console::wprintfln(const wchar_t *fmt, ...) {
@@ -805,9 +805,7 @@ void Console::wprintfln(const wchar_t *fmt, ...) {
     va_start(ap, fmt);
     vswprintf(buffer, 1024, fmt, ap);
     va_end(ap);
-    debug.printw(L"addwstr %ls\n", buffer);
-    ::addwstr((wchar_t *) buffer);
-//    ::printw ((const wchar_t *)buffer);			/* generated:WIDEC */
+    screen.putws(buffer);
 
     clear_eol();
     newline();
@@ -845,7 +843,7 @@ void Console::gauge(int aWidth, double pct, int style) {
             break;
     }
     for (i = 0; i < toFill; i++) {
-        wprintf(L"%lc", fill);
+        write(wchar_t(fill));
     }
     mode_clear();
     while (i < aWidth) {
@@ -862,28 +860,28 @@ void Console::window(int aRow, int aCol, int aWidth, int aHeight, const char *aT
 
     // top row
     moveTo(r++, aCol);
-    wprintf(L"%lc", 0x2554);
+    write(wchar_t(0x2554));
     for (int i = 0; i < w; i++) {
-        wprintf(L"%lc", 0x2550);
+        write(wchar_t(0x2550));
     }
-    wprintf(L"%lc", 0x2557);
+    write(wchar_t(0x2557));
 
     // middle rows
     for (int hh = 0; hh < h; hh++) {
         moveTo(r++, aCol);
-        wprintf(L"%lc", 0x2551);
+        write(wchar_t(0x2551));
         for (int i = 0; i < w; i++) {
-            wprintf(L"%lc", ' ');
+            write(wchar_t(' '));
         }
-        wprintf(L"%lc", 0x2551);
+        write(wchar_t(0x2551));
     }
     // bottom row
     moveTo(r++, aCol);
-    wprintf(L"%lc", 0x255a);
+    write(wchar_t(0x255a));
     for (int i = 0; i < w; i++) {
-        wprintf(L"%lc", 0x2550);
+        write(wchar_t(0x2550));
     }
-    wprintf(L"%lc", 0x255d);
+    write(wchar_t(0x255d));
 
     if (aTitle) {
         moveTo(aRow, aCol + 2);
@@ -893,34 +891,22 @@ void Console::window(int aRow, int aCol, int aWidth, int aHeight, const char *aT
 
 void Console::newline(bool erase) {
     if (erase) {
-        clear_eol();
+        screen.newline();
+    } else {
+        screen.move(screen.row + 1, 0);
     }
-#ifdef USE_NCURSES
-    printw("\n");
-#else
-    printf("\n");
-    fflush(stdout);
-#endif
 }
 
 const char *Console::humanSize(uint64_t bytes, char *output, int maxSize) {
     static char static_buf[200];
 
-    const char *suffix[] = {"B", "KB", "MB", "GB", "TB"};
-    char length = sizeof(suffix) / sizeof(suffix[0]);
-
-    int i = 0;
-    double dblBytes = bytes;
-
-    if (bytes > 1024) {
-        for (i = 0; (bytes / 1024) > 0 && i < length - 1; i++, bytes /= 1024)
-            dblBytes = bytes / 1024.0;
-    }
-
     if (output == nullptr) {
         output = static_buf;
+        maxSize = sizeof(static_buf);
     }
-    snprintf(output, maxSize, "%.02lf %s", dblBytes, suffix[i]);
+    char buf[FORMAT_FIELD_MAX + 1];
+    buf[HumanSize(bytes).format(buf)] = '\0';
+    snprintf(output, maxSize, "%s", buf);
     return output;
 }
 
@@ -26,20 +26,32 @@
 
 #define _XOPEN_SOURCE_EXTENDED
 
+#include "Format.h"
+#include "Screen.h"
 #include <cstdint>
 #include <cstdio>
 #include <sys/ioctl.h>
 #include <termios.h>
 
+// keys read_key() returns beyond plain characters, whichever backend is in use
+const int CONSOLE_KEY_UP = 0x101,
+        CONSOLE_KEY_DOWN = 0x102,
+        CONSOLE_KEY_PAGE_UP = 0x103,
+        CONSOLE_KEY_PAGE_DOWN = 0x104,
+        CONSOLE_KEY_HOME = 0x105,
+        CONSOLE_KEY_END = 0x106;
+
 class Console {
 public:
-    // console window width and height
+    // console window width and height, or the viewport's while one is set
     uint16_t width{}, height{};
 
+    // everything is drawn here, update() sends what changed to the terminal
+    Screen screen;
+
 private:
     struct termios initial_termios{0};
-    bool aborting{}, pad{};
-    int current_pair{-1};
+    bool aborting{}, started{};
 
     uint16_t current_row{0}, current_column{0};
 
@@ -55,11 +67,22 @@ private:
     // colors
     uint8_t background{}, foreground{};
 
+    // escape sequences waiting for write_output() (ANSI backend)
+    std::string output;
+
+    void write_output();
+
+    int read_escape();
+
 public:
     Console();
 
     ~Console();
 
+    // take over the terminal: curses or the alternate screen, colors, size;
+    // until then the console is an unsized screen that nothing reaches
+    void start();
+
 public:
     // print a message and exit cleanly with exit code 1
     void abort(const char *fmt, ...);
@@ -71,6 +94,10 @@ public:
     // Also clears the screen/window.
     void resize();
 
+    // the terminal has been resized (SIGWINCH)
+    void resized();
+
+    // send the changed cells to the terminal
     void update();
 
     uint16_t cursor_row();
@@ -83,7 +110,12 @@ public:
 public:
     void raw(bool on = true);
 
-    bool read_character(int *c, bool timeout = false);
+    // wait for a key
+    bool read_character(int *c);
+
+    // a key if one is waiting, without blocking; call until it returns false.
+    // Cursor keys come back as CONSOLE_KEY_*.
+    bool read_key(int *c);
 
 public:
     // enable/disable cursor
@@ -101,6 +133,14 @@ public:
     // address cursor
     void moveTo(uint16_t r, uint16_t c);
 
+    // Draw into a rectangle of the window: moveTo(0, 0) is its top left
+    // corner, output is clipped to it, and width/height are its size, so a
+    // panel lays itself out for whatever it was given.
+    void viewport(uint16_t top, uint16_t left, uint16_t w, uint16_t h);
+
+    // back to the whole window
+    void fullscreen();
+
     // printf style output to terminal
     void print(const char *fmt, ...);
 
@@ -110,6 +150,19 @@ public:
 
     void inverseln(const char *fmt, ...);
 
+    // typed fields (see Format.h) straight into the screen, no format string
+    template<typename... Fields>
+    void write(const Fields &... fields) {
+        (write_field(screen, fields), ...);
+    }
+
+    // same, with newline
+    template<typename... Fields>
+    void writeln(const Fields &... fields) {
+        (write_field(screen, fields), ...);
+        newline();
+    }
+
     // wprintf style output to terminal
     void wprintf(const wchar_t *fmt, ...);
 
@@ -0,0 +1,192 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_DEVICETABLE_H
+#define CCTOP_DEVICETABLE_H
+
+#include "Clock.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// updates a device may be missing before its slot is retired
+const int DEVICE_GRACE_UPDATES = 5;
+
+// Refers to a device without a name lookup.  The generation changes whenever
+// the slot is retired, so a handle kept across updates goes stale instead of
+// silently pointing at whatever device reused the slot.
+struct DeviceHandle {
+    uint32_t slot{UINT32_MAX};
+    uint32_t generation{};
+};
+
+template<typename T>
+struct Device {
+    std::string name;
+    uint32_t generation{};
+    uint64_t seen{};       // update in which it was last sampled
+    bool live{false};      // slot is in use
+    bool present{false};   // sampled in the latest update
+    bool primed{false};    // has a previous sample, so delta is meaningful
+    T last, current, delta;
+};
+
+//
+// Devices (CPUs, disks, interfaces) keyed by name, each holding its last,
+// current and delta samples.  T needs a default constructor and
+// diff(T *newer, T *older).
+//
+// A sample is begin(), sample(name) for every device that still exists, then
+// end().  Devices missing for DEVICE_GRACE_UPDATES updates are retired and
+// their slots reused, so hosts that churn veths or loop devices don't grow
+// without bound.
+//
+template<typename T>
+class DeviceTable {
+public:
+    Interval interval; // between the last two updates, for rates
+
+public:
+    explicit DeviceTable(int grace = DEVICE_GRACE_UPDATES) : grace(grace) {}
+
+    ~DeviceTable() {
+        for (auto *d: slots) {
+            delete d;
+        }
+        slots.clear();
+    }
+
+    DeviceTable(const DeviceTable &) = delete;
+
+    DeviceTable &operator=(const DeviceTable &) = delete;
+
+public:
+    void begin() {
+        tick++;
+        interval.stamp();
+    }
+
+    // record to fill in with the current counters for name
+    T *sample(const std::string &name) {
+        Device<T> *d = find(name);
+        if (!d) {
+            d = allocate(name);
+        }
+        if (d->seen != tick) {
+            d->last = d->current;
+            d->seen = tick;
+        }
+        return &d->current;
+    }
+
+    void end() {
+        for (uint32_t slot = 0; slot < slots.size(); slot++) {
+            Device<T> *d = slots[slot];
+            if (!d->live) {
+                continue;
+            }
+            if (d->seen == tick) {
+                d->delta.diff(&d->current, d->primed ? &d->last : &d->current);
+                d->present = d->primed = true;
+            } else if (tick - d->seen >= uint64_t(grace)) {
+                retire(slot);
+            } else {
+                d->present = d->primed = false;
+            }
+        }
+    }
+
+    Device<T> *find(const std::string &name) {
+        auto it = index.find(name);
+        return it == index.end() ? nullptr : slots[it->second];
+    }
+
+    DeviceHandle handle(const std::string &name) const {
+        DeviceHandle h;
+        auto it = index.find(name);
+        if (it != index.end()) {
+            h.slot = it->second;
+            h.generation = slots[it->second]->generation;
+        }
+        return h;
+    }
+
+    // nullptr if the device behind the handle has been retired
+    Device<T> *get(const DeviceHandle &h) {
+        if (h.slot >= slots.size()) {
+            return nullptr;
+        }
+        Device<T> *d = slots[h.slot];
+        return d->live && d->generation == h.generation ? d : nullptr;
+    }
+
+    // call f(Device<T> &) for each device present in the latest update, by name
+    template<typename F>
+    void each(F f) {
+        for (const auto &kv: index) {
+            Device<T> *d = slots[kv.second];
+            if (d->present) {
+                f(*d);
+            }
+        }
+    }
+
+    size_t size() const { return index.size(); }
+
+    size_t capacity() const { return slots.size(); }
+
+protected:
+    int grace;
+    uint64_t tick{};
+    std::vector<Device<T> *> slots;
+    std::vector<uint32_t> free_slots;
+    std::map<std::string, uint32_t> index;
+
+    Device<T> *allocate(const std::string &name) {
+        uint32_t slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            uint32_t generation = slots[slot]->generation;
+            *slots[slot] = Device<T>();
+            slots[slot]->generation = generation;
+        } else {
+            slot = uint32_t(slots.size());
+            slots.push_back(new Device<T>());
+        }
+        Device<T> *d = slots[slot];
+        d->name = name;
+        d->live = true;
+        index[name] = slot;
+        return d;
+    }
+
+    void retire(uint32_t slot) {
+        Device<T> *d = slots[slot];
+        index.erase(d->name);
+        d->name.clear();
+        d->name.shrink_to_fit();
+        d->live = d->present = d->primed = false;
+        d->generation++;
+        free_slots.push_back(slot);
+    }
+};
+
+#endif //CCTOP_DEVICETABLE_H
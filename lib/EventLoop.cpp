@@ -0,0 +1,222 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "EventLoop.h"
+#include "Clock.h"
+#include <cerrno>
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <sys/event.h>
+#else
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#endif
+
+const int EVENT_BATCH = 16;
+
+#ifdef __APPLE__
+const uintptr_t TIMER_IDENT = 1;
+
+EventLoop::EventLoop() {
+    queue = kqueue();
+}
+
+EventLoop::~EventLoop() {
+    if (queue >= 0) {
+        close(queue);
+    }
+}
+
+void EventLoop::watch(int fd, uint32_t events, std::function<void()> f) {
+    handlers[fd] = std::move(f);
+    // a kqueue descriptor (or anything else) that has news is just readable;
+    // deleting a filter that isn't there fails harmlessly
+    struct kevent ev[2]{};
+    EV_SET(&ev[0], fd, EVFILT_READ, events & (EVENT_READ | EVENT_PRIORITY) ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+    EV_SET(&ev[1], fd, EVFILT_WRITE, events & EVENT_WRITE ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+    for (auto &e: ev) {
+        kevent(queue, &e, 1, nullptr, 0, nullptr);
+    }
+}
+
+void EventLoop::unwatch(int fd) {
+    struct kevent ev[2]{};
+    EV_SET(&ev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&ev[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    for (auto &e: ev) {
+        kevent(queue, &e, 1, nullptr, 0, nullptr);
+    }
+    handlers.erase(fd);
+}
+
+void EventLoop::every(uint64_t ms, std::function<void()> f) {
+    tick = std::move(f);
+    // periodic from when it's added, in milliseconds by default; kqueue
+    // keeps to the schedule rather than rearming after each tick
+    struct kevent ev{};
+    EV_SET(&ev, TIMER_IDENT, EVFILT_TIMER, EV_ADD | EV_ENABLE, 0, intptr_t(ms), nullptr);
+    kevent(queue, &ev, 1, nullptr, 0, nullptr);
+}
+
+void EventLoop::on_signal(int sig, std::function<void()> f) {
+    signal_handlers[sig] = std::move(f);
+    // EVFILT_SIGNAL still sees ignored signals
+    signal(sig, SIG_IGN);
+    struct kevent ev{};
+    EV_SET(&ev, sig, EVFILT_SIGNAL, EV_ADD, 0, 0, nullptr);
+    kevent(queue, &ev, 1, nullptr, 0, nullptr);
+}
+
+int EventLoop::wait(int timeout) {
+    struct kevent events[EVENT_BATCH];
+    timespec ts{timeout / 1000, (timeout % 1000) * 1000000L};
+    int n = kevent(queue, nullptr, 0, events, EVENT_BATCH, timeout < 0 ? nullptr : &ts);
+    if (n < 0) {
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        const struct kevent &ev = events[i];
+        if (ev.filter == EVFILT_TIMER) {
+            if (tick) {
+                tick();
+            }
+        } else if (ev.filter == EVFILT_SIGNAL) {
+            auto it = signal_handlers.find(int(ev.ident));
+            if (it != signal_handlers.end()) {
+                it->second();
+            }
+        } else {
+            // looked up each time, an earlier handler may have unwatched it
+            auto it = handlers.find(int(ev.ident));
+            if (it != handlers.end()) {
+                it->second();
+            }
+        }
+    }
+    return n;
+}
+#else
+EventLoop::EventLoop() {
+    queue = epoll_create1(EPOLL_CLOEXEC);
+    sigemptyset(&signals);
+}
+
+EventLoop::~EventLoop() {
+    for (int fd: {timer_fd, signal_fd, queue}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void EventLoop::add(int fd, uint32_t events) {
+    epoll_event ev{};
+    ev.events = (events & EVENT_READ ? uint32_t(EPOLLIN) : 0) | (events & EVENT_PRIORITY ? uint32_t(EPOLLPRI) : 0) |
+                (events & EVENT_WRITE ? uint32_t(EPOLLOUT) : 0);
+    ev.data.fd = fd;
+    if (epoll_ctl(queue, EPOLL_CTL_ADD, fd, &ev) < 0 && errno == EEXIST) {
+        epoll_ctl(queue, EPOLL_CTL_MOD, fd, &ev);
+    }
+}
+
+void EventLoop::watch(int fd, uint32_t events, std::function<void()> f) {
+    handlers[fd] = std::move(f);
+    add(fd, events);
+}
+
+void EventLoop::unwatch(int fd) {
+    epoll_ctl(queue, EPOLL_CTL_DEL, fd, nullptr);
+    handlers.erase(fd);
+}
+
+void EventLoop::every(uint64_t ms, std::function<void()> f) {
+    tick = std::move(f);
+    if (timer_fd < 0) {
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        add(timer_fd, EVENT_READ);
+    }
+    // Absolute deadlines on CLOCK_MONOTONIC: first = now + ms, then every ms
+    // after that, however late each tick's work finishes, so ticks don't
+    // drift.
+    uint64_t first = monotonic_ns() + ms * 1000000ull;
+    itimerspec spec{};
+    spec.it_interval.tv_sec = time_t(ms / 1000);
+    spec.it_interval.tv_nsec = long(ms % 1000) * 1000000L;
+    spec.it_value.tv_sec = time_t(first / 1000000000ull);
+    spec.it_value.tv_nsec = long(first % 1000000000ull);
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void EventLoop::on_signal(int sig, std::function<void()> f) {
+    signal_handlers[sig] = std::move(f);
+    sigaddset(&signals, sig);
+    // blocked, so it's only delivered through the signalfd
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    bool created = signal_fd < 0;
+    signal_fd = signalfd(signal_fd, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (created) {
+        add(signal_fd, EVENT_READ);
+    }
+}
+
+void EventLoop::read_timer() {
+    // # of expirations; a late wakeup still runs the tick just once
+    uint64_t expirations;
+    if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations) && tick) {
+        tick();
+    }
+}
+
+void EventLoop::read_signals() {
+    signalfd_siginfo info{};
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        auto it = signal_handlers.find(int(info.ssi_signo));
+        if (it != signal_handlers.end()) {
+            it->second();
+        }
+    }
+}
+
+int EventLoop::wait(int timeout) {
+    epoll_event events[EVENT_BATCH];
+    int n = epoll_wait(queue, events, EVENT_BATCH, timeout);
+    if (n < 0) {
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        if (fd == timer_fd) {
+            read_timer();
+        } else if (fd == signal_fd) {
+            read_signals();
+        } else {
+            // looked up each time, an earlier handler may have unwatched it
+            auto it = handlers.find(fd);
+            if (it != handlers.end()) {
+                it->second();
+            }
+        }
+    }
+    return n;
+}
+#endif
+
+EventLoop eventLoop;
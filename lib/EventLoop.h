@@ -0,0 +1,90 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_EVENTLOOP_H
+#define CCTOP_EVENTLOOP_H
+
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+// what a watched descriptor is waited on for
+const uint32_t EVENT_READ = 0x01;
+const uint32_t EVENT_PRIORITY = 0x02; // POLLPRI, e.g. /proc/self/mountinfo
+const uint32_t EVENT_WRITE = 0x04;    // room to write, e.g. a socket a send() filled
+
+//
+// Waits on everything cctop reacts to at once: keys on stdin, the update
+// tick, signals, and any descriptor a collector wants to hear from.  On
+// Linux that's one epoll set holding a timerfd and a signalfd; on MacOS a
+// kqueue with EVFILT_TIMER and EVFILT_SIGNAL filters.  Nothing polls, so
+// between ticks cctop is asleep in wait() until a key arrives.
+//
+// Signals given to on_signal() are blocked (Linux) or ignored (MacOS), and
+// their handlers run from wait() like any other event, so they can do
+// anything, not just async-signal-safe things.
+//
+class EventLoop {
+public:
+    EventLoop();
+
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+
+    EventLoop &operator=(const EventLoop &) = delete;
+
+public:
+    // Call f whenever fd is ready (level triggered; f should consume it).
+    // Watching a descriptor again replaces its events and handler.
+    void watch(int fd, uint32_t events, std::function<void()> f);
+
+    void unwatch(int fd);
+
+    // call f every ms milliseconds, replacing any previous timer
+    void every(uint64_t ms, std::function<void()> f);
+
+    // call f when sig arrives, instead of its usual handling
+    void on_signal(int sig, std::function<void()> f);
+
+    // Wait up to timeout ms (-1 forever) and run the handlers of whatever is
+    // ready.  Returns # of events handled.
+    int wait(int timeout = -1);
+
+protected:
+    int queue{-1}; // epoll or kqueue descriptor
+    std::map<int, std::function<void()>> handlers;        // by descriptor
+    std::map<int, std::function<void()>> signal_handlers; // by signal
+    std::function<void()> tick;
+#ifndef __APPLE__
+    int timer_fd{-1}, signal_fd{-1};
+    sigset_t signals{};
+
+    void add(int fd, uint32_t events);
+
+    void read_timer();
+
+    void read_signals();
+#endif
+};
+
+extern EventLoop eventLoop;
+
+#endif //CCTOP_EVENTLOOP_H
@@ -0,0 +1,299 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_FORMAT_H
+#define CCTOP_FORMAT_H
+
+//
+// Typed fields for Console::write(), which format straight into the Screen
+// without a printf format string, varargs, or a scratch buffer per line:
+//
+//   console.writeln("  ", Text(name, -16), ' ', Grouped(bytes, 13), ' ', Percent(pct, 6, 1));
+//
+// is "  %-16s %'13lld %6.1f%%".  Negative widths left align, like printf.
+// The locale's thousands separator and decimal point are looked up once
+// instead of on every number.
+//
+
+#include "Screen.h"
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// longest number field, padding included
+const int FORMAT_FIELD_MAX = 64;
+
+class FormatLocale {
+public:
+    char thousands[8]{};
+    int thousands_length{};
+    char decimal{'.'};
+
+public:
+    // the locale as of the first call (main() sets it before drawing)
+    static const FormatLocale &current() {
+        static FormatLocale locale;
+        return locale;
+    }
+
+protected:
+    FormatLocale() {
+        const lconv *lc = localeconv();
+        if (lc->thousands_sep && strlen(lc->thousands_sep) < sizeof(thousands)) {
+            strcpy(thousands, lc->thousands_sep);
+            thousands_length = int(strlen(thousands));
+        }
+        if (lc->decimal_point && lc->decimal_point[0]) {
+            decimal = lc->decimal_point[0];
+        }
+    }
+};
+
+// Write the digits of v so they end just before end, grouped by thousands
+// if group is set.  Returns the number of chars written.
+inline int format_digits(char *end, uint64_t v, bool group) {
+    const FormatLocale &locale = FormatLocale::current();
+    char *p = end;
+    int digits = 0;
+    do {
+        if (group && digits && digits % 3 == 0) {
+            p -= locale.thousands_length;
+            memcpy(p, locale.thousands, locale.thousands_length);
+        }
+        *--p = char('0' + v % 10);
+        v /= 10;
+        digits++;
+    } while (v);
+    return int(end - p);
+}
+
+// right (width > 0) or left (width < 0) align the len chars at s within out
+inline int format_align(char *out, const char *s, int len, int width) {
+    int w = width < 0 ? -width : width;
+    if (w > FORMAT_FIELD_MAX) {
+        w = FORMAT_FIELD_MAX;
+    }
+    int pad = w > len ? w - len : 0;
+    if (width > 0) {
+        memset(out, ' ', pad);
+        memmove(&out[pad], s, len);
+    } else {
+        memmove(out, s, len);
+        memset(&out[len], ' ', pad);
+    }
+    return len + pad;
+}
+
+inline int format_integer(char *out, int64_t v, int width, bool group) {
+    char buf[FORMAT_FIELD_MAX];
+    char *end = &buf[FORMAT_FIELD_MAX];
+    uint64_t magnitude = v < 0 ? 0 - uint64_t(v) : uint64_t(v);
+    int len = format_digits(end, magnitude, group);
+    if (v < 0) {
+        end[-++len] = '-';
+    }
+    return format_align(out, end - len, len, width);
+}
+
+inline int format_fixed(char *out, double v, int width, int precision, char suffix) {
+    char buf[FORMAT_FIELD_MAX];
+    int len;
+    if (std::isnan(v) || std::isinf(v) || std::fabs(v) > 1e15) {
+        len = snprintf(buf, sizeof(buf), "%.*f", precision, v);
+    } else {
+        static const double scale[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        precision = precision < 0 ? 0 : precision > 6 ? 6 : precision;
+        int64_t scaled = std::llround(std::fabs(v) * scale[precision]);
+        auto whole = uint64_t(scaled / int64_t(scale[precision])),
+                fraction = uint64_t(scaled % int64_t(scale[precision]));
+        char *end = &buf[FORMAT_FIELD_MAX - 8];
+        len = format_digits(end, whole, false);
+        if (v < 0 && scaled) {
+            end[-++len] = '-';
+        }
+        memmove(buf, end - len, len);
+        if (precision) {
+            buf[len++] = FormatLocale::current().decimal;
+            for (int i = precision - 1; i >= 0; i--) {
+                buf[len + i] = char('0' + fraction % 10);
+                fraction /= 10;
+            }
+            len += precision;
+        }
+    }
+    if (suffix) {
+        // the suffix isn't counted in width, as in printf("%6.1f%%")
+        len = format_align(out, buf, len, width);
+        out[len++] = suffix;
+        return len;
+    }
+    return format_align(out, buf, len, width);
+}
+
+// v for programs rather than people: up to 3 decimals without trailing
+// zeros, and always a '.' whatever the locale says
+inline int format_plain(char *out, double v) {
+    if (std::isnan(v) || std::isinf(v) || std::fabs(v) >= 1e15) {
+        // beyond what the fixed point can hold
+        return snprintf(out, FORMAT_FIELD_MAX, "%.0f", v);
+    }
+    char buf[FORMAT_FIELD_MAX];
+    char *end = &buf[32];
+    int64_t scaled = std::llround(std::fabs(v) * 1000);
+    int len = format_digits(end, uint64_t(scaled / 1000), false);
+    if (v < 0 && scaled) {
+        end[-++len] = '-';
+    }
+    memcpy(out, end - len, len);
+    auto fraction = int(scaled % 1000);
+    if (fraction) {
+        char digits[4] = {'.', char('0' + fraction / 100), char('0' + fraction / 10 % 10), char('0' + fraction % 10)};
+        int n = 4;
+        while (digits[n - 1] == '0') {
+            n--;
+        }
+        memcpy(&out[len], digits, n);
+        len += n;
+    }
+    return len;
+}
+
+// %'lld: integer with thousands separators
+struct Grouped {
+    int64_t value;
+    int width;
+
+    explicit Grouped(int64_t value, int width = 0) : value(value), width(width) {}
+
+    int format(char *out) const { return format_integer(out, value, width, true); }
+};
+
+// %lld
+struct Number {
+    int64_t value;
+    int width;
+
+    explicit Number(int64_t value, int width = 0) : value(value), width(width) {}
+
+    int format(char *out) const { return format_integer(out, value, width, false); }
+};
+
+// %.Nf
+struct Fixed {
+    double value;
+    int width, precision;
+
+    explicit Fixed(double value, int width = 0, int precision = 1) : value(value), width(width), precision(precision) {}
+
+    int format(char *out) const { return format_fixed(out, value, width, precision, '\0'); }
+};
+
+// %.Nf%%
+struct Percent {
+    double value;
+    int width, precision;
+
+    explicit Percent(double value, int width = 0, int precision = 1) : value(value), width(width), precision(precision) {}
+
+    int format(char *out) const { return format_fixed(out, value, width, precision, '%'); }
+};
+
+// bytes as Console::humanSize() shows them, e.g. "1.50 GB"
+struct HumanSize {
+    uint64_t bytes;
+    int width;
+
+    explicit HumanSize(uint64_t bytes, int width = 0) : bytes(bytes), width(width) {}
+
+    int format(char *out) const {
+        static const char *suffix[] = {"B", "KB", "MB", "GB", "TB"};
+        uint64_t b = bytes;
+        double value = double(b);
+        int i = 0;
+        if (b > 1024) {
+            for (; b / 1024 > 0 && i < 4; i++, b /= 1024) {
+                value = double(b) / 1024.0;
+            }
+        }
+        char buf[FORMAT_FIELD_MAX];
+        int len = format_fixed(buf, value, 0, 2, '\0');
+        buf[len++] = ' ';
+        for (const char *s = suffix[i]; *s;) {
+            buf[len++] = *s++;
+        }
+        return format_align(out, buf, len, width);
+    }
+};
+
+// %-W.Ms: text padded to width, cut at max glyphs (by default the width,
+// 0 for no limit)
+struct Text {
+    const char *s;
+    int width, max;
+
+    explicit Text(const char *s, int width = 0, int max = -1) : s(s ? s : ""), width(width),
+                                                               max(max < 0 ? (width < 0 ? -width : width) : max) {}
+
+    explicit Text(const std::string &s, int width = 0, int max = -1) : Text(s.c_str(), width, max) {}
+};
+
+//
+// Console::write() dispatch
+//
+
+inline void write_field(Screen &screen, const char *s) {
+    screen.puts(s);
+}
+
+inline void write_field(Screen &screen, char c) {
+    screen.put(wchar_t(c));
+}
+
+inline void write_field(Screen &screen, wchar_t c) {
+    screen.put(c);
+}
+
+inline void write_field(Screen &screen, const std::string &s) {
+    screen.puts(s.c_str());
+}
+
+inline void write_field(Screen &screen, const Text &t) {
+    int w = t.width < 0 ? -t.width : t.width;
+    int len = t.width > 0 ? Screen::glyphs(t.s, t.max) : 0;
+    for (int i = len; i < t.width; i++) {
+        screen.put(L' ');
+    }
+    len = screen.puts(t.s, t.max);
+    for (int i = len; t.width < 0 && i < w; i++) {
+        screen.put(L' ');
+    }
+}
+
+template<typename Field>
+inline void write_field(Screen &screen, const Field &field) {
+    char buf[FORMAT_FIELD_MAX + 8];
+    buf[field.format(buf)] = '\0';
+    // not just ASCII; the thousands separator can be multibyte
+    screen.puts(buf);
+}
+
+#endif //CCTOP_FORMAT_H
@@ -0,0 +1,171 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "FrameStream.h"
+#include "EventLoop.h"
+#include "Socket.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+FrameStream::~FrameStream() {
+    if (fd >= 0) {
+        eventLoop.unwatch(fd);
+        ::close(fd);
+    }
+}
+
+bool FrameStream::open(const char *a, std::function<void(bool frame)> f) {
+    changed = std::move(f);
+    return socket_address(a, address, address_length);
+}
+
+bool FrameStream::connect() {
+    if (current != CLOSED) {
+        return true;
+    }
+    fd = socket(address.ss_family, SOCK_STREAM, 0);
+    if (fd < 0 || !socket_nonblocking(fd)) {
+        close(errno);
+        return false;
+    }
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    received.clear();
+    greeted = false;
+    error = 0;
+    if (::connect(fd, (sockaddr *) &address, address_length) == 0) {
+        current = OPEN;
+        eventLoop.watch(fd, EVENT_READ, [this] { receive(); });
+    } else if (errno == EINPROGRESS) {
+        current = CONNECTING;
+        eventLoop.watch(fd, EVENT_WRITE, [this] { connected(); });
+    } else {
+        close(errno);
+        return false;
+    }
+    return true;
+}
+
+void FrameStream::connected() {
+    int e = 0;
+    socklen_t length = sizeof(e);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &e, &length) < 0) {
+        e = errno;
+    }
+    if (e) {
+        close(e);
+        changed(false);
+        return;
+    }
+    current = OPEN;
+    eventLoop.watch(fd, EVENT_READ, [this] { receive(); });
+    changed(false);
+}
+
+const char *FrameStream::status() const {
+    switch (current) {
+        case CONNECTING:
+            return "connecting";
+        case OPEN:
+            return frames ? "connected" : "waiting";
+        default:
+            if (error == EPROTO) {
+                return "not a cctop -d";
+            }
+            return error ? strerror(error) : "gone";
+    }
+}
+
+void FrameStream::receive() {
+    char buf[65536];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            received.append(buf, size_t(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            // what's already here is still shown
+            close(n == 0 ? 0 : errno);
+            changed(false);
+            return;
+        }
+        break;
+    }
+
+    size_t used = 0;
+    if (!greeted && received.size() >= sizeof(RECORDING_MAGIC)) {
+        if (memcmp(received.data(), RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+            close(EPROTO);
+            changed(false);
+            return;
+        }
+        greeted = true;
+        used = sizeof(RECORDING_MAGIC);
+    }
+    while (greeted) {
+        // a varint length, then that much frame
+        auto *p = (const uint8_t *) received.data() + used, *end = (const uint8_t *) received.data() + received.size();
+        uint64_t length = 0;
+        int shift = 0;
+        while (p < end && shift < 64 && (*p & 0x80)) {
+            length |= uint64_t(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p < end && shift < 64) {
+            length |= uint64_t(*p++) << shift;
+        } else if (p == end && length <= RECORDING_MAX_FRAME) {
+            // the rest of the length is on its way
+            break;
+        }
+        if (shift >= 64 || length > RECORDING_MAX_FRAME) {
+            // garbage, or more than we'll hold for anyone
+            close(EPROTO);
+            changed(false);
+            return;
+        }
+        if (length > uint64_t(end - p)) {
+            break;
+        }
+        // a delta that comes before any keyframe has nothing to go on; the keyframe is coming
+        if (reader.decode(p, size_t(length))) {
+            frames++;
+            changed(true);
+        }
+        used = size_t(p - (const uint8_t *) received.data()) + size_t(length);
+    }
+    received.erase(0, used);
+    changed(false);
+}
+
+void FrameStream::close(int why) {
+    if (fd >= 0) {
+        eventLoop.unwatch(fd);
+        ::close(fd);
+        fd = -1;
+    }
+    current = CLOSED;
+    error = why;
+}
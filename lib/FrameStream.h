@@ -0,0 +1,90 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_FRAMESTREAM_H
+#define CCTOP_FRAMESTREAM_H
+
+#include "Recording.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <sys/socket.h>
+
+//
+// The viewer's end of a -d daemon or agent.  It connects without blocking,
+// so a host that's slow to answer holds up nothing else on the event
+// loop, reads whatever has arrived whenever the socket is readable, and
+// decodes each whole frame into reader as it comes.  When the other end
+// goes away it's closed; connect() starts again.
+//
+class FrameStream {
+public:
+    enum State {
+        CLOSED,
+        CONNECTING,
+        OPEN,
+    };
+
+    FrameStream() = default;
+
+    FrameStream(const FrameStream &) = delete;
+
+    FrameStream &operator=(const FrameStream &) = delete;
+
+    ~FrameStream();
+
+public:
+    // Look up address (see Socket.h) without connecting yet; false (with
+    // errno) if it isn't one.  f(true) runs after each frame is decoded,
+    // f(false) after anything else that changes what's shown.
+    bool open(const char *address, std::function<void(bool frame)> f);
+
+    // Start connecting, if it isn't already; false (with errno) if that
+    // failed straight away.  Neither way calls f.
+    bool connect();
+
+    State state() const { return current; }
+
+    // a word or two on the connection, for a status line
+    const char *status() const;
+
+public:
+    RecordingReader reader; // the frame last decoded
+    uint64_t frames{0};     // decoded since open()
+
+protected:
+    sockaddr_storage address{};
+    socklen_t address_length{0};
+    int fd{-1};
+    State current{CLOSED};
+    int error{0};         // why it last closed; 0 if the other end just went
+    std::string received; // the part of the stream not decoded yet
+    bool greeted{false};  // the magic number has been checked
+    std::function<void(bool frame)> changed;
+
+    // EVENT_WRITE while connecting: it either went through or didn't
+    void connected();
+
+    void receive();
+
+    // doesn't call changed(); the caller does
+    void close(int why);
+};
+
+#endif //CCTOP_FRAMESTREAM_H
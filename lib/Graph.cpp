@@ -0,0 +1,123 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Graph.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+const wchar_t BRAILLE_BLANK = 0x2800;
+
+// Dots lit in a cell, bottom up, for a fill of 1-4 dots in each column:
+//   left  7 3 2 1 -> 0x40 0x04 0x02 0x01
+//   right 8 6 5 4 -> 0x80 0x20 0x10 0x08
+static const int32_t left_dots[GRAPH_DOTS_Y] = {0x40, 0x04, 0x02, 0x01},
+        right_dots[GRAPH_DOTS_Y] = {0x80, 0x20, 0x10, 0x08};
+
+// v * scale rounded up, so any activity shows a dot, clamped to 0..top; NaN
+// (a gap) is 0
+static void quantize(const float *v, int32_t *out, uint32_t n, float scale, int32_t top) {
+    uint32_t i = 0;
+#ifdef __SSE2__
+    const __m128 s = _mm_set1_ps(scale), zero = _mm_setzero_ps(),
+            up = _mm_set1_ps(0.999f), hi = _mm_set1_ps(float(top));
+    for (; i + 4 <= n; i += 4) {
+        // max returns its second operand if either is NaN
+        __m128 x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&v[i]), s), zero);
+        x = _mm_min_ps(_mm_add_ps(x, up), hi);
+        _mm_storeu_si128((__m128i *) &out[i], _mm_cvttps_epi32(x));
+    }
+#endif
+    for (; i < n; i++) {
+        float x = v[i] * scale;
+        x = x > 0 ? x : 0;
+        x = std::min(x + 0.999f, float(top));
+        out[i] = int32_t(x);
+    }
+}
+
+Graph::Graph(uint16_t rows) : height(rows ? rows : 1) {}
+
+void Graph::plot(const Series *series, uint16_t columns, float max) {
+    uint32_t slots = uint32_t(columns) * GRAPH_DOTS_X;
+    bool resized = columns != width;
+    if (resized) {
+        width = columns;
+        levels.assign(slots, 0);
+        glyphs.assign(size_t(height) * width, BRAILLE_BLANK);
+    }
+    next.assign(slots, 0);
+    if (series && max > 0) {
+        uint32_t have = std::min(series->size(), slots);
+        quantize(series->window(have), &next[slots - have], have, float(height * GRAPH_DOTS_Y) / max,
+                 height * GRAPH_DOTS_Y);
+    }
+
+    // only the columns between the first and last changed slot need glyphs
+    int first = -1, last = -1;
+    for (uint32_t i = 0; i < slots; i++) {
+        if (resized || next[i] != levels[i]) {
+            if (first < 0) {
+                first = int(i / GRAPH_DOTS_X);
+            }
+            last = int(i / GRAPH_DOTS_X);
+        }
+    }
+    levels.swap(next);
+    changed = first < 0 ? 0 : uint16_t(last - first + 1);
+    if (first >= 0) {
+        render(first, last);
+    }
+}
+
+void Graph::render(int first, int last) {
+    for (int r = 0; r < height; r++) {
+        // dots below this row
+        int32_t base = (height - 1 - r) * GRAPH_DOTS_Y;
+        wchar_t *out = &glyphs[size_t(r) * width];
+        int c = first;
+#ifdef __SSE2__
+        static_assert(sizeof(wchar_t) == 4, "4 glyphs per vector");
+        const __m128i b = _mm_set1_epi32(base), blank = _mm_set1_epi32(BRAILLE_BLANK);
+        for (; c + 4 <= last + 1; c += 4) {
+            // levels holds left, right, left, right...; split them
+            __m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) &levels[c * 2])),
+                    hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) &levels[c * 2 + 4]));
+            __m128i left = _mm_sub_epi32(_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), b),
+                    right = _mm_sub_epi32(_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), b),
+                    glyph = blank;
+            for (int d = 0; d < GRAPH_DOTS_Y; d++) {
+                __m128i k = _mm_set1_epi32(d);
+                glyph = _mm_or_si128(glyph, _mm_and_si128(_mm_cmpgt_epi32(left, k), _mm_set1_epi32(left_dots[d])));
+                glyph = _mm_or_si128(glyph, _mm_and_si128(_mm_cmpgt_epi32(right, k), _mm_set1_epi32(right_dots[d])));
+            }
+            _mm_storeu_si128((__m128i *) &out[c], glyph);
+        }
+#endif
+        for (; c <= last; c++) {
+            int32_t left = levels[c * 2] - base, right = levels[c * 2 + 1] - base, glyph = BRAILLE_BLANK;
+            for (int d = 0; d < GRAPH_DOTS_Y; d++) {
+                glyph |= (left > d ? left_dots[d] : 0) | (right > d ? right_dots[d] : 0);
+            }
+            out[c] = wchar_t(glyph);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_GRAPH_H
+#define CCTOP_GRAPH_H
+
+#include "History.h"
+#include <cstdint>
+#include <vector>
+
+// braille cells are 2 dots wide and 4 high; each dot column is one sample
+const int GRAPH_DOTS_X = 2, GRAPH_DOTS_Y = 4;
+
+//
+// Bar graph of a Series in braille, so a cell holds two samples at four
+// levels each instead of one sample at eight (the CPU sparkline's blocks).
+//
+// plot() keeps the previous frame's levels and only recomputes the glyphs
+// of the column range that changed; the sample levels and glyphs are
+// computed four at a time (SSE2 where available).
+//
+class Graph {
+public:
+    explicit Graph(uint16_t rows = 2);
+
+public:
+    // The latest samples of series, newest at the right, as bars scaled so
+    // max fills the graph.  A missing series or samples plot as empty.
+    void plot(const Series *series, uint16_t columns, float max);
+
+    // glyphs of row r (0 is the top), columns() wide
+    const wchar_t *row(uint16_t r) const { return &glyphs[size_t(r) * width]; }
+
+    uint16_t rows() const { return height; }
+
+    uint16_t columns() const { return width; }
+
+    // columns whose glyphs the last plot() recomputed
+    uint16_t changed{};
+
+protected:
+    uint16_t height, width{};
+    std::vector<int32_t> levels, next; // dots high, per sample slot
+    std::vector<wchar_t> glyphs;       // height x width
+
+    void render(int first, int last);
+};
+
+#endif //CCTOP_GRAPH_H
@@ -1,16 +1,30 @@
 #include "Help.h"
 #include "Console.h"
 #include "Options.h"
+#include "../common/Fleet.h"
+#include "../common/Replay.h"
 
 static const char *true_false(bool t) {
     return t ? "[ TRUE ]" : "[ FALSE ]";
 }
 
+static const char *sort_name(int sort) {
+    switch (sort) {
+        case Options::SORT_DELAY:
+            return "[ DELAY ]";
+        case Options::SORT_CSW:
+            return "[ ICSW ]";
+        case Options::SORT_CPU:
+        default:
+            return "[ CPU ]";
+    }
+}
+
 void Help::show() {
     if (options.showHelp) {
         int margin = 4, padding = 2,
                 row = margin, col = margin,
-                height = 15;
+                height = 19 + (replay.active() && !replay.live()) + fleet.active();
 
         console.window(row, margin,
                        console.width - margin - margin, height,
@@ -30,12 +44,32 @@ void Help::show() {
         console.moveTo(row++, col);
         console.print("D %-48.48s %s", "toggles condensed Disk Activity display", true_false(options.condenseDisk));
         console.moveTo(row++, col);
+        console.print("F %-48.48s %s", "toggles condensed Filesystems display", true_false(options.condenseFilesystems));
+        console.moveTo(row++, col);
         console.print("N %-48.48s %s", "toggles condensed Network display", true_false(options.condenseNetwork));
         console.moveTo(row++, col);
+        console.print("G %-48.48s %s", "toggles CPU, Memory, Network and Disk graphs", true_false(options.showGraphs));
+        console.moveTo(row++, col);
+        console.print("I %-48.48s %s", "toggles condensed Interrupts display", true_false(options.condenseInterrupts));
+        console.moveTo(row++, col);
         console.print("P %-48.48s %s", "toggles condensed Process List display", true_false(options.condenseProcesses));
 
         console.moveTo(row++, col);
         console.print("X %-48.48s %s", "toggles remove blank lines", true_false(options.condenseMain));
+        console.moveTo(row++, col);
+        console.print("S %-48.48s %s", "sorts processes by CPU, delay, context switches", sort_name(options.sortProcesses));
+        console.moveTo(row++, col);
+        console.print("Up/Down, PgUp/PgDn and End select a process, Home goes back to the top");
+        console.moveTo(row++, col);
+        console.print("/ filters processes: name, user:name, pid:n-m, cg:name; Esc clears");
+        if (replay.active() && !replay.live()) {
+            console.moveTo(row++, col);
+            console.print("Space pauses the replay, ,/. step, [/] and {/} skip, 0-9 jump");
+        }
+        if (fleet.active()) {
+            console.moveTo(row++, col);
+            console.print("Up/Down pick a host, Enter shows it, Esc goes back to the fleet");
+        }
 //        console.moveTo(row++, col);
 //        console.print("^L to refresh");
 
@@ -0,0 +1,128 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "History.h"
+#include <algorithm>
+
+static uint32_t clamp_depth(uint32_t depth) {
+    return depth == 0 ? 1 : std::min(depth, HISTORY_MAX_DEPTH);
+}
+
+Series::Series(uint32_t depth) : max_depth(clamp_depth(depth)) {
+    capacity = std::min(max_depth, HISTORY_INITIAL_CAPACITY);
+    data.assign(size_t(capacity) * 2, HISTORY_GAP);
+}
+
+// move the latest samples that fit into new storage
+void Series::reshape(uint32_t new_capacity) {
+    uint32_t keep = std::min(count, new_capacity);
+    std::vector<float> fresh(size_t(new_capacity) * 2, HISTORY_GAP);
+    const float *w = window(keep);
+    std::copy(w, w + keep, fresh.begin());
+    std::copy(w, w + keep, fresh.begin() + new_capacity);
+    data.swap(fresh);
+    capacity = new_capacity;
+    count = keep;
+    head = keep == new_capacity ? 0 : keep;
+}
+
+void Series::set_depth(uint32_t depth) {
+    max_depth = clamp_depth(depth);
+    if (capacity > max_depth) {
+        reshape(max_depth);
+    }
+}
+
+void Series::append(float value) {
+    if (count == capacity && capacity < max_depth) {
+        reshape(std::min(capacity * 2, max_depth));
+    }
+    data[head] = data[head + capacity] = value;
+    if (++head == capacity) {
+        head = 0;
+    }
+    if (count < capacity) {
+        count++;
+    }
+    updated = history().tick;
+}
+
+float Series::peak(uint32_t n) const {
+    const float *w = window(n);
+    float max = 0;
+    for (uint32_t i = 0; i < std::min(n, count); i++) {
+        // NaN compares false, so gaps are skipped
+        if (w[i] > max) {
+            max = w[i];
+        }
+    }
+    return max;
+}
+
+Series *History::series(const std::string &name, uint32_t d) {
+    auto it = all.find(name);
+    if (it != all.end()) {
+        return it->second.get();
+    }
+    auto *s = new Series(d ? d : default_depth);
+    s->updated = tick;
+    all.emplace(name, std::unique_ptr<Series>(s));
+    return s;
+}
+
+const Series *History::find(const std::string &name) const {
+    auto it = all.find(name);
+    return it == all.end() ? nullptr : it->second.get();
+}
+
+void History::set_depth(uint32_t d) {
+    for (auto &kv: all) {
+        if (kv.second->max_depth == default_depth) {
+            kv.second->set_depth(d);
+        }
+    }
+    default_depth = clamp_depth(d);
+}
+
+void History::remove(const std::string &name) {
+    all.erase(name);
+}
+
+void History::end() {
+    for (auto it = all.begin(); it != all.end();) {
+        if (tick - it->second->updated >= uint64_t(HISTORY_GRACE_UPDATES)) {
+            it = all.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t History::footprint() const {
+    size_t bytes = 0;
+    for (const auto &kv: all) {
+        bytes += kv.second->data.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+History &history() {
+    static History registry;
+    return registry;
+}
@@ -0,0 +1,153 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_HISTORY_H
+#define CCTOP_HISTORY_H
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// samples kept per series by default (an hour at one update per second),
+// and the most -H/--history allows (a day)
+const uint32_t HISTORY_DEFAULT_DEPTH = 3600;
+const uint32_t HISTORY_MAX_DEPTH = 86400;
+
+// updates a series may go without a sample before it's dropped
+const int HISTORY_GRACE_UPDATES = 5;
+
+// a series' storage starts this small and doubles as it fills, so short
+// lived processes and devices don't pay for the full depth
+const uint32_t HISTORY_INITIAL_CAPACITY = 64;
+
+// stands in for a sample that wasn't available (offline CPU, no counters)
+const float HISTORY_GAP = NAN;
+
+//
+// Fixed depth time series, one sample per update.
+//
+// Storage is mirrored: each sample is written at i and at i + capacity, so
+// the latest n samples are always one contiguous run, oldest first, that a
+// graph can read without wrapping or copying.  Appends are O(1) (amortized
+// while the storage is still growing toward the depth).
+//
+class Series {
+public:
+    explicit Series(uint32_t depth);
+
+public:
+    void append(float value);
+
+    // the latest n samples (at most size()), oldest first
+    const float *window(uint32_t n) const {
+        if (n > count) {
+            n = count;
+        }
+        return &data[head + capacity - n];
+    }
+
+    // latest sample, HISTORY_GAP if none
+    float latest() const { return count ? data[head + capacity - 1] : HISTORY_GAP; }
+
+    // # of samples held
+    uint32_t size() const { return count; }
+
+    uint32_t depth() const { return max_depth; }
+
+    // keeps the latest samples that fit
+    void set_depth(uint32_t depth);
+
+    // largest sample in the latest n, 0 if none
+    float peak(uint32_t n) const;
+
+protected:
+    friend class History;
+
+    std::vector<float> data; // 2 * capacity
+    uint32_t max_depth, capacity{}, head{}, count{};
+    uint64_t updated{};      // History update of the latest append
+
+    void reshape(uint32_t new_capacity);
+};
+
+//
+// Registry of every Series, by name: "cpu/CPU0", "memory/used",
+// "disk/disk0/read", "net/en0/rx", "process/1234/cpu" and so on.
+//
+// main() brackets each round of updates with begin() and end(); a series
+// that hasn't been appended to for HISTORY_GRACE_UPDATES updates (its
+// device or process is gone) is dropped then.  Series pointers stay valid
+// until then, so collectors can keep them instead of looking up by name.
+//
+class History {
+public:
+public:
+    uint32_t depth() const { return default_depth; }
+
+    // for new series and every existing one that was using the old depth
+    void set_depth(uint32_t depth);
+
+    // find or create name; depth 0 is the registry's depth
+    Series *series(const std::string &name, uint32_t depth = 0);
+
+    // nullptr if there's no such series
+    const Series *find(const std::string &name) const;
+
+    // forget name now, e.g. when its pid has been reused
+    void remove(const std::string &name);
+
+    // forget every series, for a replay that starts over; pointers to them
+    // are no good after this
+    void clear() { all.clear(); }
+
+    void begin() { tick++; }
+
+    void end();
+
+    size_t size() const { return all.size(); }
+
+    // call f(name, series) for each series appended to this update, by name
+    template<typename F>
+    void each(F f) const {
+        for (const auto &kv: all) {
+            if (kv.second->updated == tick) {
+                f(kv.first, *kv.second);
+            }
+        }
+    }
+
+    // bytes of sample storage in use
+    size_t footprint() const;
+
+protected:
+    friend class Series;
+
+    uint32_t default_depth{HISTORY_DEFAULT_DEPTH};
+    uint64_t tick{};
+    std::map<std::string, std::unique_ptr<Series>> all;
+};
+
+// The registry.  A function rather than a global since collectors take their
+// first sample from their constructors, during static initialization.
+History &history();
+
+#endif //CCTOP_HISTORY_H
@@ -0,0 +1,218 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Layout.h"
+#include "Console.h"
+#include <algorithm>
+
+// a full width pane, or a run of panes sharing the width: [begin, split) in
+// the left column and [split, end) in the right, split == end for one column
+struct Block {
+    size_t begin, end, split;
+    uint16_t rows;
+};
+
+Pane &Layout::add(std::function<uint16_t()> rows, std::function<uint16_t(bool newline)> print) {
+    panes.emplace_back();
+    Pane &pane = panes.back();
+    pane.rows = std::move(rows);
+    pane.print = std::move(print);
+    return pane;
+}
+
+// rows a column of panes takes, with a blank line between each
+static uint16_t column_rows(const std::vector<Pane> &panes, size_t begin, size_t end, bool separators) {
+    int rows = 0, shown = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (panes[i].height) {
+            rows += panes[i].height;
+            shown++;
+        }
+    }
+    if (separators && shown > 1) {
+        rows += shown - 1;
+    }
+    return uint16_t(rows);
+}
+
+// stack a column of panes downward from top; returns the bottom one
+static Pane *stack(std::vector<Pane> &panes, size_t begin, size_t end,
+                   uint16_t top, uint16_t left, uint16_t width, bool separators) {
+    Pane *last = nullptr;
+    for (size_t i = begin; i < end; i++) {
+        Pane &p = panes[i];
+        if (!p.height) {
+            continue;
+        }
+        if (last && separators) {
+            last->separator = true;
+            top++;
+        }
+        p.top = top;
+        p.left = left;
+        p.width = width;
+        top += p.height;
+        last = &p;
+    }
+    return last;
+}
+
+bool Layout::place(uint16_t width, uint16_t height, bool separators) {
+    std::vector<Block> blocks;
+    std::vector<uint16_t> preferred(panes.size());
+
+    for (size_t i = 0; i < panes.size();) {
+        Block b{i, i + 1, i + 1, 0};
+        uint16_t needed = panes[i].column_width;
+        if (needed) {
+            while (b.end < panes.size() && panes[b.end].column_width) {
+                needed = std::max(needed, panes[b.end].column_width);
+                b.end++;
+            }
+        }
+        bool split = needed && b.end - b.begin > 1 && width >= 2 * needed;
+
+        // panes size themselves by console.width, so measure at the width they'll get
+        console.viewport(0, 0, split ? width / 2 : width, height);
+        for (size_t j = b.begin; j < b.end; j++) {
+            Pane &p = panes[j];
+            preferred[j] = p.rows();
+            p.height = p.elastic ? std::min(p.elastic, preferred[j]) : preferred[j];
+            p.separator = false;
+        }
+        i = b.end;
+        if (!split) {
+            // stacked, each is a block of its own and can be left out by itself
+            for (size_t j = b.begin; j < b.end; j++) {
+                blocks.push_back({j, j + 1, j + 1, panes[j].height});
+            }
+            continue;
+        }
+        // the most even split that keeps the order
+        b.rows = UINT16_MAX;
+        for (size_t s = b.begin + 1; s < b.end; s++) {
+            uint16_t rows = std::max(column_rows(panes, b.begin, s, separators),
+                                     column_rows(panes, s, b.end, separators));
+            if (rows < b.rows) {
+                b.rows = rows;
+                b.split = s;
+            }
+        }
+        blocks.push_back(b);
+    }
+    console.fullscreen();
+
+    int total = 0, shown = 0;
+    for (auto &b: blocks) {
+        if (b.rows) {
+            total += b.rows;
+            shown++;
+        }
+    }
+    if (separators && shown > 1) {
+        total += shown - 1;
+    }
+    bool fits = total <= height;
+    if (fits) {
+        // the rows nobody asked for go to the elastic panes
+        int spare = height - total;
+        for (auto &b: blocks) {
+            Pane &p = panes[b.begin];
+            if (!p.elastic || b.split != b.end) {
+                continue;
+            }
+            int grow = std::min(spare, preferred[b.begin] - p.height);
+            p.height += grow;
+            b.rows += grow;
+            spare -= grow;
+        }
+    }
+
+    // top to bottom; a block that would run off the bottom is left out
+    uint16_t row = 0;
+    std::vector<Pane *> above; // bottom panes of the block above, which get the blank line
+    for (auto &b: blocks) {
+        if (!b.rows) {
+            continue;
+        }
+        uint16_t top = row + (separators && !above.empty() ? 1 : 0);
+        if (top + b.rows > height) {
+            for (size_t j = b.begin; j < b.end; j++) {
+                panes[j].height = 0;
+            }
+            continue;
+        }
+        if (separators) {
+            for (auto *p: above) {
+                p->separator = true;
+            }
+        }
+        above.clear();
+        uint16_t left_width = b.split == b.end ? width : width / 2;
+        if (Pane *p = stack(panes, b.begin, b.split, top, 0, left_width, separators)) {
+            above.push_back(p);
+        }
+        if (Pane *p = stack(panes, b.split, b.end, top, left_width, width - left_width, separators)) {
+            above.push_back(p);
+        }
+        row = top + b.rows;
+    }
+    return fits;
+}
+
+void Layout::arrange(uint16_t width, uint16_t height, bool separators) {
+    for (auto &p: panes) {
+        if (p.compact) {
+            *p.compact = p.wanted && *p.wanted;
+        }
+    }
+    if (place(width, height, separators) || (separators && place(width, height, false))) {
+        return;
+    }
+    bool more = false;
+    for (auto &p: panes) {
+        if (p.compact && !*p.compact) {
+            *p.compact = true;
+            more = true;
+        }
+    }
+    if (more) {
+        place(width, height, false);
+    }
+}
+
+uint16_t Layout::print() {
+    uint16_t rows = 0;
+    // anything no pane covers, beside a short column or below the last pane, stays blank
+    console.fullscreen();
+    console.clear();
+    for (auto &p: panes) {
+        if (!p.height) {
+            continue;
+        }
+        console.viewport(p.top, p.left, p.width, p.height + p.separator);
+        p.print(p.separator);
+        console.mode_clear();
+        rows = std::max(rows, uint16_t(p.top + p.height + p.separator));
+    }
+    console.fullscreen();
+    return rows;
+}
+
+Layout layout;
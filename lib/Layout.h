@@ -0,0 +1,85 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_LAYOUT_H
+#define CCTOP_LAYOUT_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//
+// A panel as the layout sees it.  rows() is measured before anything is
+// drawn, and print() then draws into a viewport exactly that tall, plus the
+// blank line after it if it was given one.
+//
+struct Pane {
+    // rows print() takes at console.width, not counting the blank line; 0 hides it
+    std::function<uint16_t()> rows;
+    std::function<uint16_t(bool newline)> print;
+
+    // The pane's compact form, if it has one: print() looks at *compact,
+    // *wanted is the user's toggle.  When rows are short the layout turns
+    // compact on regardless.
+    bool *compact{};
+    const bool *wanted{};
+
+    // nonzero for a pane that takes whatever rows are left, but no fewer than
+    // this (the process list); always full width
+    uint16_t elastic{};
+
+    // nonzero for a pane that can share the width with its neighbors, if it
+    // gets at least this many columns
+    uint16_t column_width{};
+
+    // where arrange() put it; height is 0 if it didn't fit or has nothing to show
+    uint16_t top{}, left{}, width{}, height{};
+    bool separator{};
+};
+
+//
+// Decides where every panel goes before any of them draws.  Panes are
+// stacked in the order they were added; runs of panes that can share the
+// width are split into two balanced columns when the window is wide enough
+// for both.  When rows are short the blank lines between panes go first,
+// then panes switch to their compact forms, and if it still doesn't fit,
+// whatever falls off the bottom isn't drawn at all.
+//
+class Layout {
+public:
+    std::vector<Pane> panes;
+
+public:
+    // the returned pane can be adjusted until the next add()
+    Pane &add(std::function<uint16_t()> rows, std::function<uint16_t(bool newline)> print);
+
+    // place the panes in a window this size
+    void arrange(uint16_t width, uint16_t height, bool separators);
+
+    // draw the panes that were placed, each in its own viewport; returns # rows used
+    uint16_t print();
+
+protected:
+    // one pass at the panes' current forms; false if something was left out
+    bool place(uint16_t width, uint16_t height, bool separators);
+};
+
+extern Layout layout;
+
+#endif //CCTOP_LAYOUT_H
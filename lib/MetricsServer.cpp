@@ -0,0 +1,322 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "MetricsServer.h"
+#include "Clock.h"
+#include "EventLoop.h"
+#include "Format.h"
+#include "Socket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // MacOS: SO_NOSIGPIPE is set on the socket instead
+#endif
+
+static const char CONTENT_TYPE[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+// a response that's the same every time
+static std::shared_ptr<const MetricsServer::Response> fixed(const char *status, const char *body) {
+    auto r = std::make_shared<MetricsServer::Response>();
+    char head[256];
+    snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n"
+                                 "Connection: close\r\n\r\n", status, strlen(body));
+    r->head = head;
+    r->body = body;
+    return r;
+}
+
+MetricsServer::~MetricsServer() {
+    if (fd >= 0) {
+        close(fd);
+        if (!path.empty()) {
+            unlink(path.c_str());
+        }
+    }
+}
+
+bool MetricsServer::listen(const char *address) {
+    fd = socket_listen(address, path);
+    if (fd < 0) {
+        return false;
+    }
+    eventLoop.watch(fd, EVENT_READ, [this] { accept_clients(); });
+    return true;
+}
+
+static void label(std::string &out, const char *name, const std::string &value) {
+    out += '{';
+    out += name;
+    out += "=\"";
+    for (char c: value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += "\"}";
+}
+
+const MetricsServer::Metric &MetricsServer::metric(const std::string &name) {
+    auto it = metrics.find(name);
+    if (it != metrics.end()) {
+        it->second.published = publishes;
+        return it->second;
+    }
+    std::vector<std::string> parts;
+    for (size_t start = 0;;) {
+        size_t slash = name.find('/', start);
+        parts.push_back(name.substr(start, slash - start));
+        if (slash == std::string::npos) {
+            break;
+        }
+        start = slash + 1;
+    }
+    const std::string &group = parts.front(), &last = parts.back();
+    // the device between the group and the measurement, "all" for the totals
+    std::string device = parts.size() == 3 ? parts[1] : "all";
+    Metric m{"", "", "", publishes};
+    if (group == "cpu" && parts.size() == 2) {
+        m.family = "cctop_cpu_utilization_percent";
+        label(m.labels, "cpu", last == "CPU" ? "all" : last.substr(3));
+        m.help = "CPU in use, percent";
+    } else if (group == "cpu" && parts.size() == 3) {
+        m.family = "cctop_cpu_" + last + "_percent";
+        label(m.labels, "cpu", device == "CPU" ? "all" : device.substr(3));
+        m.help = last == "user" ? "CPU in user mode, percent" : "CPU in system mode, percent";
+    } else if (group == "sched" && parts.size() == 3) {
+        m.family = "cctop_sched_wait_ms_per_second";
+        label(m.labels, "cpu", device == "CPU" ? "all" : device.substr(3));
+        m.help = "Time runnable but waiting for a CPU, ms per second";
+    } else if ((group == "memory" || group == "swap") && parts.size() == 2) {
+        m.family = "cctop_" + group + "_" + last + "_bytes";
+        m.help = group == "memory" ? "Memory, bytes" : "Swap, bytes";
+    } else if (group == "vm" && parts.size() == 2) {
+        m.family = "cctop_vm_" + last + "_per_second";
+        m.help = "Paging and swapping, pages per second";
+    } else if (group == "disk" && parts.size() <= 3) {
+        m.family = "cctop_disk_" + last + (last == "ops" ? "_per_second" : "_bytes_per_second");
+        label(m.labels, "device", device);
+        m.help = last == "ops" ? "Disk operations per second" : "Disk throughput, bytes per second";
+    } else if (group == "net" && parts.size() <= 3) {
+        bool packets = last.size() > 8 && !last.compare(last.size() - 8, 8, "_packets");
+        m.family = "cctop_network_" + last + (packets ? "_per_second" : "_bytes_per_second");
+        label(m.labels, "interface", device);
+        m.help = packets ? "Network packets per second" : "Network traffic, bytes per second";
+    } else if (group == "fs" && parts.size() >= 3) {
+        // the mount point is everything between, slashes and all
+        bool inodes = !last.compare(0, 6, "inodes");
+        m.family = "cctop_filesystem_" + last + (inodes ? "" : "_bytes");
+        label(m.labels, "mountpoint", name.substr(3, name.size() - 3 - last.size() - 1));
+        m.help = inodes ? "Filesystem inodes" : "Filesystem space, bytes";
+    } else {
+        // something new: its name, made legal
+        m.family = "cctop_";
+        for (char c: name) {
+            m.family += isalnum((unsigned char) c) ? c : '_';
+        }
+    }
+    return metrics.emplace(name, std::move(m)).first->second;
+}
+
+void MetricsServer::publish(const Snapshot &snapshot) {
+    if (fd < 0) {
+        return;
+    }
+    publishes++;
+    samples.clear();
+    for (const auto &field: snapshot.fields) {
+        const Metric &m = metric(*field.name);
+        if (!std::isnan(field.value)) {
+            samples.emplace_back(&m, field.value);
+        }
+    }
+    // series History has retired (a veth or loop device that's gone) go too
+    if (metrics.size() > snapshot.fields.size()) {
+        for (auto it = metrics.begin(); it != metrics.end();) {
+            if (it->second.published != publishes) {
+                it = metrics.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // a family's samples have to be together; the devices stay in name order
+    std::stable_sort(samples.begin(), samples.end(), [](const auto &a, const auto &b) {
+        return a.first->family < b.first->family;
+    });
+
+    auto r = std::make_shared<Response>();
+    if (latest) {
+        r->body.reserve(latest->body.capacity());
+    }
+    const std::string *family = nullptr;
+    char number[FORMAT_FIELD_MAX];
+    for (const auto &sample: samples) {
+        const Metric &m = *sample.first;
+        if (!family || *family != m.family) {
+            family = &m.family;
+            r->body += "# TYPE " + m.family + " gauge\n";
+            if (*m.help) {
+                r->body += "# HELP " + m.family + ' ' + m.help + '\n';
+            }
+        }
+        r->body += m.family;
+        r->body += m.labels;
+        r->body += ' ';
+        r->body.append(number, size_t(format_plain(number, sample.second)));
+        r->body += '\n';
+    }
+    r->body += "# EOF\n";
+    char head[256];
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                 "Connection: close\r\n\r\n", CONTENT_TYPE, r->body.size());
+    r->head = head;
+    latest = std::move(r);
+
+    // clients that never finished asking, or never read the answer
+    uint64_t now = monotonic_ns() / 1000000;
+    std::vector<int> expired;
+    for (const auto &kv: clients) {
+        if (now - kv.second.opened_ms > METRICS_CLIENT_TIMEOUT_MS) {
+            expired.push_back(kv.first);
+        }
+    }
+    for (int client: expired) {
+        close_client(client);
+    }
+}
+
+void MetricsServer::accept_clients() {
+    for (;;) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            // EAGAIN: that's all of them
+            return;
+        }
+        if (clients.size() >= METRICS_MAX_CLIENTS || !socket_nonblocking(client)) {
+            close(client);
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        clients[client].opened_ms = monotonic_ns() / 1000000;
+        eventLoop.watch(client, EVENT_READ, [this, client] { read_request(client); });
+    }
+}
+
+void MetricsServer::read_request(int client) {
+    Client &c = clients[client];
+    char buf[2048];
+    for (;;) {
+        ssize_t n = recv(client, buf, sizeof(buf), 0);
+        if (n > 0) {
+            c.request.append(buf, size_t(n));
+            if (c.request.size() > METRICS_MAX_REQUEST) {
+                close_client(client);
+                return;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        bool failed = n < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+        bool complete = c.request.find("\r\n\r\n") != std::string::npos || c.request.find("\n\n") != std::string::npos;
+        if (failed || (n == 0 && !complete)) {
+            // gone (one that's done sending can still be answered)
+            close_client(client);
+            return;
+        }
+        if (!complete) {
+            // more to come
+            return;
+        }
+        break;
+    }
+
+    static const auto not_found = fixed("404 Not Found", "try /metrics\n"),
+            not_allowed = fixed("405 Method Not Allowed", "GET or HEAD\n"),
+            not_ready = fixed("503 Service Unavailable", "no sample yet\n");
+    // "GET /metrics?x HTTP/1.1"
+    size_t space = c.request.find(' ');
+    std::string method = c.request.substr(0, space);
+    std::string target = space == std::string::npos ? "" : c.request.substr(space + 1, c.request.find_first_of(" ?\r\n", space + 1) - space - 1);
+    if (method != "GET" && method != "HEAD") {
+        c.response = not_allowed;
+    } else if (target != "/metrics" && target != "/") {
+        c.response = not_found;
+    } else {
+        c.response = latest ? latest : not_ready;
+    }
+    c.head_only = method == "HEAD";
+    send_response(client);
+}
+
+void MetricsServer::send_response(int client) {
+    Client &c = clients[client];
+    const Response &r = *c.response;
+    size_t body = c.head_only ? 0 : r.body.size(), total = r.head.size() + body;
+    iovec iov[2];
+    int n = 0;
+    if (c.sent < r.head.size()) {
+        iov[n++] = {(void *) (r.head.data() + c.sent), r.head.size() - c.sent};
+    }
+    size_t offset = c.sent > r.head.size() ? c.sent - r.head.size() : 0;
+    if (offset < body) {
+        iov[n++] = {(void *) (r.body.data() + offset), body - offset};
+    }
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n;
+    ssize_t sent = sendmsg(client, &msg, MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            eventLoop.watch(client, EVENT_WRITE, [this, client] { send_response(client); });
+        } else {
+            close_client(client);
+        }
+        return;
+    }
+    c.sent += size_t(sent);
+    if (c.sent >= total) {
+        close_client(client);
+    } else {
+        // the socket buffer is full: the rest when there's room
+        eventLoop.watch(client, EVENT_WRITE, [this, client] { send_response(client); });
+    }
+}
+
+void MetricsServer::close_client(int client) {
+    eventLoop.unwatch(client);
+    close(client);
+    clients.erase(client);
+}
+
+MetricsServer metricsServer;
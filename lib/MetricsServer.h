@@ -0,0 +1,119 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_METRICSSERVER_H
+#define CCTOP_METRICSSERVER_H
+
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// scrapes being served at once; more are turned away
+const size_t METRICS_MAX_CLIENTS = 64;
+
+// longest request taken, and how long a client gets to send it and read the reply
+const size_t METRICS_MAX_REQUEST = 8192;
+const uint64_t METRICS_CLIENT_TIMEOUT_MS = 10000;
+
+//
+// --listen: serves the latest snapshot over HTTP in the OpenMetrics text
+// format, for Prometheus (or curl) to scrape at /metrics.
+//
+// publish() renders the whole response, headers and all, once per
+// update; a scrape is then an accept(), a read of the request and a
+// single sendmsg() straight from that buffer.  Every socket is
+// non-blocking and driven by the event loop, so a slow or stuck client
+// never holds up sampling: it keeps the response it was given (they're
+// shared, not copied) until it has read it or timed out.
+//
+// Series names become metric families: cpu/CPU3 is
+// cctop_cpu_utilization_percent{cpu="3"}, disk/disk0/read is
+// cctop_disk_read_bytes_per_second{device="disk0"}, fs//home/used is
+// cctop_filesystem_used_bytes{mountpoint="/home"}, and so on.
+//
+class MetricsServer {
+public:
+    MetricsServer() = default;
+
+    MetricsServer(const MetricsServer &) = delete;
+
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    ~MetricsServer();
+
+public:
+    // "port", "host:port", "[v6 address]:port" or a unix socket path (one
+    // with a /); false (with errno) if it can't be listened on
+    bool listen(const char *address);
+
+    bool listening() const { return fd >= 0; }
+
+    // render snapshot for every scrape from now until the next publish()
+    void publish(const Snapshot &snapshot);
+
+public:
+    // a reply, rendered ahead
+    struct Response {
+        std::string head, body;
+    };
+
+protected:
+
+    // what a series name is in OpenMetrics
+    struct Metric {
+        std::string family; // metric name
+        std::string labels; // {name="value"}, or empty
+        const char *help;
+        uint64_t published; // the publish() that last had the series
+    };
+
+    struct Client {
+        std::shared_ptr<const Response> response; // nullptr until the request is in
+        std::string request;
+        bool head_only{false}; // HEAD
+        size_t sent{0};
+        uint64_t opened_ms{0};
+    };
+
+    int fd{-1};
+    std::string path; // unix socket, removed on exit
+    std::shared_ptr<const Response> latest;
+    std::unordered_map<int, Client> clients;
+    std::unordered_map<std::string, Metric> metrics; // by series name; only those in the last publish()
+    uint64_t publishes{0};
+    std::vector<std::pair<const Metric *, float>> samples;
+
+    const Metric &metric(const std::string &name);
+
+    void accept_clients();
+
+    void read_request(int client);
+
+    void send_response(int client);
+
+    void close_client(int client);
+};
+
+extern MetricsServer metricsServer;
+
+#endif //CCTOP_METRICSSERVER_H
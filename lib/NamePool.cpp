@@ -0,0 +1,117 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "NamePool.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+uint32_t NamePool::intern(const char *name) {
+    std::string key(name);
+    for (auto &c: key) {
+        c = char(tolower((unsigned char) c));
+    }
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+        if (used[it->second] != sweeps) {
+            used[it->second] = sweeps;
+            live++;
+        }
+        return it->second;
+    }
+    auto id = uint32_t(offsets.size());
+    offsets.push_back(uint32_t(pool.size()));
+    pool.insert(pool.end(), key.begin(), key.end());
+    pool.push_back('\0');
+    ids.emplace(std::move(key), id);
+    used.push_back(sweeps);
+    live++;
+    return id;
+}
+
+bool NamePool::sweep() {
+    uint32_t dead = size() - live;
+    bool compact = dead > 64 && dead > live;
+    if (compact) {
+        std::vector<char> kept;
+        std::vector<uint32_t> starts;
+        remap.assign(size(), UINT32_MAX);
+        ids.clear();
+        for (uint32_t id = 0; id < size(); id++) {
+            if (used[id] != sweeps) {
+                continue;
+            }
+            const char *s = name(id);
+            size_t len = strlen(s);
+            remap[id] = uint32_t(starts.size());
+            starts.push_back(uint32_t(kept.size()));
+            kept.insert(kept.end(), s, s + len + 1);
+            ids.emplace(std::string(s, len), remap[id]);
+        }
+        pool.swap(kept);
+        offsets.swap(starts);
+        used.assign(size(), sweeps);
+    }
+    sweeps++;
+    live = 0;
+    return compact;
+}
+
+bool NamePool::contains(uint32_t id, const std::string &needle) const {
+    return strstr(name(id), needle.c_str()) != nullptr;
+}
+
+uint32_t NamePool::id_at(size_t offset) const {
+    return uint32_t(std::upper_bound(offsets.begin(), offsets.end(), uint32_t(offset)) - offsets.begin() - 1);
+}
+
+void NamePool::scan(const std::string &needle, const std::function<void(size_t)> &at) const {
+    size_t n = pool.size(), len = needle.size();
+    if (len == 0 || len > n) {
+        return;
+    }
+    const char *s = pool.data(), *k = needle.data();
+    size_t i = 0;
+#ifdef __SSE2__
+    // Compare 16 candidate positions at once against the needle's first and
+    // last bytes; only positions where both agree get a memcmp.
+    const __m128i first = _mm_set1_epi8(k[0]), last = _mm_set1_epi8(k[len - 1]);
+    for (; i + len - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (s + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (s + i + len - 1));
+        auto mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (len <= 2 || memcmp(s + pos + 1, k + 1, len - 2) == 0) {
+                at(pos);
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + len <= n; i++) {
+        if (s[i] == k[0] && memcmp(s + i, k, len) == 0) {
+            at(i);
+        }
+    }
+}
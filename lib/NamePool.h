@@ -0,0 +1,85 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_NAMEPOOL_H
+#define CCTOP_NAMEPOOL_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Process names, each stored once, lowercased and back to back in one
+// buffer with a nul after each.  A substring search then runs over the
+// whole buffer in one pass (16 bytes at a time with SSE2) instead of once
+// per process, and a match can't run from one name into the next.
+//
+// Short-lived processes with unique names (mktemp'd scripts, build steps)
+// would grow it forever, so names not interned between two sweeps are
+// dropped once they're most of the pool, and the rest get new ids.
+//
+class NamePool {
+public:
+    // id of name, adding it the first time it's seen; either way it's in use
+    uint32_t intern(const char *name);
+
+    // once per update, after every live name is interned; true if ids moved,
+    // in which case moved(id) is each old id's new one
+    bool sweep();
+
+    uint32_t moved(uint32_t id) const { return remap[id]; }
+
+    // the lowercased name
+    const char *name(uint32_t id) const { return &pool[offsets[id]]; }
+
+    uint32_t size() const { return uint32_t(offsets.size()); }
+
+    // call f(id) once for every name containing needle, which must be lowercase
+    template<typename F>
+    void search(const std::string &needle, F f) const {
+        uint32_t last = UINT32_MAX;
+        scan(needle, [&](size_t at) {
+            uint32_t id = id_at(at);
+            if (id != last) {
+                f(id);
+                last = id;
+            }
+        });
+    }
+
+    // same, for one name
+    bool contains(uint32_t id, const std::string &needle) const;
+
+protected:
+    std::vector<char> pool;
+    std::vector<uint32_t> offsets; // where each id starts in pool
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<uint32_t> used;   // by id, the sweep it was last interned in
+    std::vector<uint32_t> remap;  // by old id, from the last sweep that moved them
+    uint32_t sweeps{1}, live{0};  // live: ids interned since the last sweep
+
+    // call at(offset) for every occurrence of needle in pool, in order
+    void scan(const std::string &needle, const std::function<void(size_t)> &at) const;
+
+    uint32_t id_at(size_t offset) const;
+};
+
+#endif //CCTOP_NAMEPOOL_H
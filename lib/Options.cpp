@@ -4,10 +4,205 @@
 
 #include "Options.h"
 #include <cstdlib>
+#include <cstring>
+#include <getopt.h>
 
 #include "Console.h"
+#include "SharedSnapshot.h"
+#include "../macos/ProcessList.h"
+#include "../common/Fleet.h"
+#include "../common/Replay.h"
+
+static const char *usage =
+        "usage: cctop [options]\n"
+        "  -H, --history=N[smh]   keep N seconds (or minutes, hours) of history per\n"
+        "                         metric, at most 24h (default 1h)\n"
+        "  -f, --format=FORMAT    don't draw; write one record per update to\n"
+        "                         stdout as ndjson or csv\n"
+        "  -o, --output=FILE      append the records to FILE (ndjson unless -f)\n"
+        "  -n, --count=N          stop after N records\n"
+        "  -r, --record=FILE      don't draw; append every update to the recording\n"
+        "                         FILE (with -f, as well as writing records)\n"
+        "  -R, --replay=FILE      play back a recording made with -r\n"
+        "  -d, --daemon=ADDRESS   don't draw; sample for any number of -c viewers\n"
+        "                         connected to a unix socket path or [host:]port\n"
+        "                         (localhost unless a host is given)\n"
+        "  -c, --connect=ADDRESS  show what a -d daemon samples instead of sampling;\n"
+        "                         several, comma separated, for a table of hosts\n"
+        "  -l, --listen=ADDRESS   serve OpenMetrics at /metrics on [host:]port\n"
+        "                         (localhost unless a host is given) or a unix\n"
+        "                         socket path\n"
+        "  -u, --push=URL         send every update over UDP to statsd://host:port\n"
+        "                         or influx://host:port (line protocol)\n"
+        "      --push-select=PATTERNS\n"
+        "                         only push series matching these comma separated\n"
+        "                         patterns, e.g. 'cpu/CPU,memory/*,net/*'\n"
+        "      --shm[=NAME]       keep the latest update in POSIX shared memory\n"
+        "                         (default /cctop) for other programs to read\n"
+        "  -a, --alerts=RULES     check every update against the rules in RULES,\n"
+        "                         e.g. 'cpu busy: cpu/CPU > 90 for 30s clear 75'\n"
+        "      --alert-log=FILE   append firings to FILE instead of syslog\n"
+        "      --alert-exec=COMMAND\n"
+        "                         run COMMAND with /bin/sh on each firing and clear\n"
+        "  -?, --help             show this message\n";
+
+// long options without a letter
+enum {
+    OPTION_PUSH_SELECT = 0x100,
+    OPTION_SHM,
+    OPTION_ALERT_LOG,
+    OPTION_ALERT_EXEC,
+};
+
+// "90", "90s", "15m" or "2h" in seconds; 0 if it isn't one of those
+static uint32_t parse_duration(const char *s) {
+    char *end;
+    unsigned long n = strtoul(s, &end, 10);
+    if (end == s) {
+        return 0;
+    }
+    switch (*end) {
+        case '\0':
+        case 's':
+            break;
+        case 'm':
+            n *= 60;
+            break;
+        case 'h':
+            n *= 60 * 60;
+            break;
+        default:
+            return 0;
+    }
+    if (*end && end[1]) {
+        return 0;
+    }
+    return n > HISTORY_MAX_DEPTH ? 0 : uint32_t(n);
+}
+
+void Options::parse(int ac, char *av[]) {
+    static const option longopts[] = {
+            {"history", required_argument, nullptr, 'H'},
+            {"format",  required_argument, nullptr, 'f'},
+            {"output",  required_argument, nullptr, 'o'},
+            {"count",   required_argument, nullptr, 'n'},
+            {"record",  required_argument, nullptr, 'r'},
+            {"replay",  required_argument, nullptr, 'R'},
+            {"daemon",  required_argument, nullptr, 'd'},
+            {"connect", required_argument, nullptr, 'c'},
+            {"listen",  required_argument, nullptr, 'l'},
+            {"push",    required_argument, nullptr, 'u'},
+            {"push-select", required_argument, nullptr, OPTION_PUSH_SELECT},
+            {"shm",     optional_argument, nullptr, OPTION_SHM},
+            {"alerts",  required_argument, nullptr, 'a'},
+            {"alert-log", required_argument, nullptr, OPTION_ALERT_LOG},
+            {"alert-exec", required_argument, nullptr, OPTION_ALERT_EXEC},
+            {"help",    no_argument,       nullptr, '?'},
+            {nullptr,   0,                 nullptr, 0},
+    };
+    int c;
+    bool history_given = false;
+    char *end;
+    while ((c = getopt_long(ac, av, "H:f:o:n:r:R:d:c:l:u:a:?", longopts, nullptr)) != -1) {
+        switch (c) {
+            case 'H':
+                history_depth = parse_duration(optarg);
+                if (history_depth == 0) {
+                    console.abort("cctop: bad --history %s\n%s", optarg, usage);
+                }
+                history_given = true;
+                break;
+            case 'f':
+                if (!strcmp(optarg, "ndjson") || !strcmp(optarg, "json")) {
+                    format = FORMAT_NDJSON;
+                } else if (!strcmp(optarg, "csv")) {
+                    format = FORMAT_CSV;
+                } else {
+                    console.abort("cctop: bad --format %s\n%s", optarg, usage);
+                }
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'n':
+                count = strtoull(optarg, &end, 10);
+                if (end == optarg || *end || count == 0) {
+                    console.abort("cctop: bad --count %s\n%s", optarg, usage);
+                }
+                break;
+            case 'r':
+                record = optarg;
+                break;
+            case 'R':
+                replay = optarg;
+                break;
+            case 'd':
+                daemon = optarg;
+                break;
+            case 'c':
+                connect = optarg;
+                break;
+            case 'l':
+                listen = optarg;
+                break;
+            case 'u':
+                push = optarg;
+                break;
+            case OPTION_PUSH_SELECT:
+                push_select = optarg;
+                break;
+            case OPTION_SHM:
+                shm = optarg ? optarg : SHARED_DEFAULT_NAME;
+                break;
+            case 'a':
+                alerts = optarg;
+                break;
+            case OPTION_ALERT_LOG:
+                alert_log = optarg;
+                break;
+            case OPTION_ALERT_EXEC:
+                alert_exec = optarg;
+                break;
+            default:
+                console.abort("%s", usage);
+        }
+    }
+    if (optind < ac) {
+        console.abort("cctop: unexpected argument %s\n%s", av[optind], usage);
+    }
+    if (output && format == FORMAT_NONE) {
+        format = FORMAT_NDJSON;
+    }
+    if (replay && (headless() || listen || push || shm || alerts)) {
+        console.abort("cctop: --replay draws; it can't be used with -f, -o, -r, -d, -l, -u, -a or --shm\n%s", usage);
+    }
+    if (connect && (replay || headless() || listen || push || shm || alerts)) {
+        console.abort("cctop: --connect draws what a daemon sends; it can't be used with -R, -f, -o, -r, -d, -l, -u, -a or --shm\n%s", usage);
+    }
+    if ((alert_log || alert_exec) && !alerts) {
+        console.abort("cctop: --alert-log and --alert-exec need -a\n%s", usage);
+    }
+    if (replay || connect) {
+        // what there is to see in a recording
+        showGraphs = true;
+    }
+    if (headless() && !history_given) {
+        // nothing draws graphs, records only need the latest sample
+        history_depth = 1;
+    }
+}
 
 void Options::process(int c) {
+    if (processList.filter.editing && processList.filter.key(c)) {
+        console.clear();
+        return;
+    }
+    if (::replay.active() && ::replay.key(c)) {
+        return;
+    }
+    if (::fleet.active() && ::fleet.key(c)) {
+        return;
+    }
     switch (c) {
         case 3:
         case 'q':
@@ -38,16 +233,36 @@ void Options::process(int c) {
             condenseDisk = !condenseDisk;
             showHelp = false;
             break;
+        case 'f':
+        case 'F':
+            condenseFilesystems = !condenseFilesystems;
+            showHelp = false;
+            break;
         case 'n':
         case 'N':
             condenseNetwork = !condenseNetwork;
             showHelp = false;
             break;
+        case 'g':
+        case 'G':
+            showGraphs = !showGraphs;
+            showHelp = false;
+            break;
+        case 'i':
+        case 'I':
+            condenseInterrupts = !condenseInterrupts;
+            showHelp = false;
+            break;
         case 'p':
         case 'P':
             condenseProcesses = !condenseProcesses;
             showHelp = false;
             break;
+        case 's':
+        case 'S':
+            sortProcesses = (sortProcesses + 1) % SORT_MAX;
+            showHelp = false;
+            break;
         case 'x':
         case 'X':
             condenseMain = !condenseMain;
@@ -57,6 +272,28 @@ void Options::process(int c) {
         case 'h':
             showHelp = !showHelp;
             break;
+        case '/':
+            processList.filter.edit();
+            showHelp = false;
+            break;
+        case CONSOLE_KEY_UP:
+            processList.scroll_selection(-1);
+            break;
+        case CONSOLE_KEY_DOWN:
+            processList.scroll_selection(1);
+            break;
+        case CONSOLE_KEY_PAGE_UP:
+            processList.scroll_selection(-processList.rows_shown());
+            break;
+        case CONSOLE_KEY_PAGE_DOWN:
+            processList.scroll_selection(processList.rows_shown());
+            break;
+        case CONSOLE_KEY_HOME:
+            processList.unselect();
+            break;
+        case CONSOLE_KEY_END:
+            processList.scroll_selection(UINT16_MAX);
+            break;
         default:
             return;
     }
@@ -1,11 +1,23 @@
 #ifndef CCTOP_OPTIONS_H
 #define CCTOP_OPTIONS_H
 
+#include "History.h"
 #include <cstdint>
+#include <cstring>
 
 class Options {
 public:
     bool showHelp{false};
+    bool showGraphs{false};
+
+    // process list sort order
+    enum {
+        SORT_CPU,
+        SORT_DELAY, // scheduling (run queue) delay
+        SORT_CSW,   // involuntary context switches
+        SORT_MAX,
+    };
+    int sortProcesses{SORT_CPU};
 
     bool condenseMain{false},
             condenseCPU{false},
@@ -13,15 +25,49 @@ public:
             condenseMemory{false},
             condenseVirtualMemory{false},
             condenseDisk{false},
+            condenseFilesystems{false},
             condenseNetwork{false},
+            condenseInterrupts{false},
             condenseProcesses{false};
 
     uint64_t read_timeout{1000}; // in milliseconds
     uint16_t min_rows{0};
 
+    uint32_t history_depth{HISTORY_DEFAULT_DEPTH}; // samples kept per metric
+
+    // headless output (-f, -o, -n, -r)
+    enum {
+        FORMAT_NONE, // draw on the terminal
+        FORMAT_NDJSON,
+        FORMAT_CSV,
+    };
+    int format{FORMAT_NONE};
+    const char *output{nullptr}; // nullptr for stdout
+    uint64_t count{0};           // records to write, 0 for no limit
+    const char *record{nullptr}; // -r recording to append to
+    const char *replay{nullptr}; // -R recording to play back
+    const char *daemon{nullptr}; // -d socket to serve viewers on
+    const char *connect{nullptr}; // -c daemon (or comma separated agents) to view
+    const char *listen{nullptr}; // -l address to serve metrics on
+    const char *push{nullptr};   // -u URL to push metrics to
+    const char *push_select{nullptr}; // --push-select patterns
+    const char *shm{nullptr};    // --shm segment to publish in
+    const char *alerts{nullptr}; // -a rules file
+    const char *alert_log{nullptr};  // --alert-log file, nullptr for syslog
+    const char *alert_exec{nullptr}; // --alert-exec hook
+
 public:
+    // command line; exits with usage on anything it doesn't understand
+    void parse(int ac, char *av[]);
+
     void process(int c);
 
+    // writing records (or serving viewers) instead of drawing; the terminal is never touched
+    bool headless() const { return format != FORMAT_NONE || record || daemon; }
+
+    // -c with more than one address: the fleet table
+    bool fleet() const { return connect && strchr(connect, ','); }
+
 };
 
 extern Options options;
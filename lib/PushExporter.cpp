@@ -0,0 +1,320 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "PushExporter.h"
+#include "Format.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// longest name (or line prefix) packed; anything longer is cut
+const size_t PUSH_NAME_MAX = 256;
+
+PushExporter::~PushExporter() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool PushExporter::start(const char *url, const char *select, std::string &error) {
+    const char *port;
+    if (!strncmp(url, "statsd://", 9)) {
+        format = STATSD;
+        url += 9;
+        port = "8125";
+    } else if (!strncmp(url, "influx://", 9)) {
+        format = INFLUX;
+        url += 9;
+        port = "8089";
+    } else {
+        error = "expected statsd://host:port or influx://host:port";
+        return false;
+    }
+    std::string address = url, service = port;
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos && address.find(']', colon) == std::string::npos) {
+        service = address.substr(colon + 1);
+        address.erase(colon);
+    }
+    if (address.size() >= 2 && address.front() == '[' && address.back() == ']') {
+        address = address.substr(1, address.size() - 2);
+    }
+
+    addrinfo hints{}, *found = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    int rc = getaddrinfo(address.c_str(), service.c_str(), &hints, &found);
+    if (rc != 0) {
+        error = gai_strerror(rc);
+        return false;
+    }
+    // connected, so the datagrams need no address and a refusal shows up as an error
+    for (addrinfo *ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && (fcntl(fd, F_SETFD, FD_CLOEXEC) < 0 || connect(fd, ai->ai_addr, ai->ai_addrlen) < 0)) {
+            error = strerror(errno);
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) {
+        return false;
+    }
+
+    char name[256]{};
+    gethostname(name, sizeof(name) - 1);
+    // the short name, and nothing either format would read as punctuation
+    for (char *p = name; *p && *p != '.'; p++) {
+        host += isalnum((unsigned char) *p) || *p == '-' ? *p : '_';
+    }
+    if (host.empty()) {
+        host = "localhost";
+    }
+    for (const char *p = select; p && *p;) {
+        const char *comma = strchr(p, ',');
+        size_t n = comma ? size_t(comma - p) : strlen(p);
+        if (n) {
+            patterns.emplace_back(p, n);
+        }
+        p += n + (comma ? 1 : 0);
+    }
+    thread = std::thread(&PushExporter::run, this);
+    return true;
+}
+
+bool PushExporter::selected(const std::string &name) const {
+    if (patterns.empty()) {
+        return true;
+    }
+    for (const auto &pattern: patterns) {
+        if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PushExporter::publish(const Snapshot &snapshot) {
+    if (fd < 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        // an unsent batch is stale now; this one takes its place (and storage)
+        pending.time_ns = snapshot.time_ns;
+        pending.names.clear();
+        pending.values.clear();
+        for (const auto &field: snapshot.fields) {
+            if (std::isnan(field.value) || !selected(*field.name)) {
+                continue;
+            }
+            pending.values.push_back({uint32_t(pending.names.size()), uint32_t(field.name->size()), field.value});
+            pending.names += *field.name;
+        }
+        ready = true;
+    }
+    wake.notify_one();
+}
+
+void PushExporter::run() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return ready || stopping; });
+            if (stopping) {
+                return;
+            }
+            // no copying: the two batches trade storage
+            std::swap(pending, sending);
+            ready = false;
+        }
+        send(sending);
+    }
+}
+
+char *PushExporter::reserve(size_t n) {
+    if (used == 0 || lengths[used - 1] + n > PUSH_DATAGRAM_SIZE) {
+        if (used == PUSH_BATCH) {
+            flush();
+        }
+        lengths[used++] = 0;
+    }
+    char *p = &datagrams[used - 1][lengths[used - 1]];
+    lengths[used - 1] += n;
+    return p;
+}
+
+void PushExporter::flush() {
+#ifndef __APPLE__
+    mmsghdr messages[PUSH_BATCH]{};
+    iovec iov[PUSH_BATCH];
+    for (int i = 0; i < used; i++) {
+        iov[i] = {datagrams[i], lengths[i]};
+        messages[i].msg_hdr.msg_iov = &iov[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    for (int sent = 0; sent < used;) {
+        int n = sendmmsg(fd, &messages[sent], unsigned(used - sent), 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            // nobody listening, or no buffer space: this update is lost, the next may not be
+            break;
+        }
+        sent += n;
+    }
+#else
+    for (int i = 0; i < used; i++) {
+        ::send(fd, datagrams[i], lengths[i], 0);
+    }
+#endif
+    used = 0;
+}
+
+void PushExporter::send(const Batch &batch) {
+    used = 0;
+    if (format == INFLUX) {
+        send_influx(batch);
+    } else {
+        send_statsd(batch);
+    }
+    if (used) {
+        flush();
+    }
+}
+
+// copy n chars of s to out, mapping those in from to the char at the same
+// index in to (or escaping them with \ where to is nullptr); returns the length
+static size_t copy_mapped(char *out, size_t room, const char *s, size_t n, const char *from, const char *to) {
+    size_t len = 0;
+    for (size_t i = 0; i < n && len + 2 <= room; i++) {
+        const char *special = strchr(from, s[i]);
+        if (!special || !s[i]) {
+            out[len++] = s[i];
+        } else if (to) {
+            out[len++] = to[special - from];
+        } else {
+            out[len++] = '\\';
+            out[len++] = s[i];
+        }
+    }
+    return len;
+}
+
+void PushExporter::send_statsd(const Batch &batch) {
+    // cctop.<host>.
+    char line[2 * PUSH_NAME_MAX + FORMAT_FIELD_MAX + 8];
+    size_t prefix = size_t(snprintf(line, PUSH_NAME_MAX, "cctop.%s.", host.c_str()));
+    for (const auto &v: batch.values) {
+        // / separates, and : | @ mean something to StatsD
+        size_t len = prefix + copy_mapped(&line[prefix], PUSH_NAME_MAX - prefix, &batch.names[v.offset], v.length,
+                                          "/:|@ \n", "._____");
+        size_t name = len;
+        line[len++] = ':';
+        if (v.value < 0) {
+            // a signed gauge is a change to StatsD; set it to 0 first
+            memcpy(&line[len], "0|g\n", 4);
+            len += 4;
+            memcpy(&line[len], line, name + 1);
+            len += name + 1;
+        }
+        len += size_t(format_plain(&line[len], v.value));
+        memcpy(&line[len], "|g\n", 3);
+        len += 3;
+        memcpy(reserve(len), line, len);
+    }
+}
+
+void PushExporter::send_influx(const Batch &batch) {
+    char line[PUSH_DATAGRAM_SIZE], digits[FORMAT_FIELD_MAX], stamp[FORMAT_FIELD_MAX];
+    // " <ns>\n" ends every line
+    int n = format_digits(&digits[FORMAT_FIELD_MAX], batch.time_ns, false);
+    stamp[0] = ' ';
+    memcpy(&stamp[1], &digits[FORMAT_FIELD_MAX - n], size_t(n));
+    size_t stamp_length = size_t(n) + 1;
+    stamp[stamp_length++] = '\n';
+
+    size_t prefix = 0, len = 0;
+    std::string_view group, device; // of the line being built
+    auto end_line = [&] {
+        if (len > prefix) {
+            memcpy(&line[len], stamp, stamp_length);
+            len += stamp_length;
+            memcpy(reserve(len), line, len);
+        }
+        len = prefix;
+    };
+    for (const auto &v: batch.values) {
+        // group[/device]/field, or just a field of cctop's
+        std::string_view name(&batch.names[v.offset], v.length), g = "cctop", d, field = name;
+        size_t first = name.find('/'), last = name.rfind('/');
+        if (first != std::string_view::npos) {
+            g = name.substr(0, first);
+            field = name.substr(last + 1);
+            if (last > first) {
+                d = name.substr(first + 1, last - first - 1);
+            }
+        }
+        if (g != group || d != device) {
+            end_line();
+            group = g;
+            device = d;
+            // measurement,host=h[,device=d]
+            prefix = copy_mapped(line, PUSH_NAME_MAX, g.data(), g.size(), ", ", nullptr);
+            prefix += size_t(snprintf(&line[prefix], PUSH_NAME_MAX, ",host=%s", host.c_str()));
+            if (!d.empty()) {
+                memcpy(&line[prefix], ",device=", 8);
+                prefix += 8;
+                prefix += copy_mapped(&line[prefix], PUSH_NAME_MAX, d.data(), d.size(), ",= ", nullptr);
+            }
+            len = prefix;
+        }
+        char f[PUSH_NAME_MAX + FORMAT_FIELD_MAX];
+        size_t length = copy_mapped(f, PUSH_NAME_MAX, field.data(), field.size(), ",= ", nullptr);
+        f[length++] = '=';
+        length += size_t(format_plain(&f[length], v.value));
+        if (len + 1 + length + stamp_length > sizeof(line)) {
+            // too long for a datagram: the rest go on another line like it
+            end_line();
+        }
+        char separator = len == prefix ? ' ' : ',';
+        line[len++] = separator;
+        memcpy(&line[len], f, length);
+        len += length;
+    }
+    end_line();
+}
+
+PushExporter pushExporter;
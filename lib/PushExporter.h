@@ -0,0 +1,128 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_PUSHEXPORTER_H
+#define CCTOP_PUSHEXPORTER_H
+
+#include "Snapshot.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// payload per datagram: fits a 1500 byte Ethernet MTU with room for the
+// IPv6 and UDP headers (and the odd tunnel), as StatsD clients usually do
+const size_t PUSH_DATAGRAM_SIZE = 1432;
+
+// datagrams handed to one sendmmsg(); a bigger snapshot takes more calls
+const int PUSH_BATCH = 32;
+
+//
+// --push: sends every update to a StatsD or InfluxDB (line protocol)
+// listener over UDP, from a thread of its own so a slow resolver or a
+// full socket buffer never holds up sampling.
+//
+// publish() copies the selected values, names and all, into a batch whose
+// storage is kept from one update to the next, and wakes the thread; if
+// the thread is still busy with the last one, that's replaced.  The
+// thread packs whole lines into fixed datagram buffers and sends a
+// batch of them with each sendmmsg() (sendmsg() one at a time where
+// there's no sendmmsg), so once warm nothing is allocated per metric.
+//
+// StatsD gets gauges named cctop.<host>.<series with / as .>; Influx gets
+// a line per measurement and device, e.g.
+//   disk,host=mini,device=disk0 ops=12,read=4096,write=0 1700000000000000000
+//
+class PushExporter {
+public:
+    enum Format {
+        STATSD,
+        INFLUX,
+    };
+
+public:
+    PushExporter() = default;
+
+    PushExporter(const PushExporter &) = delete;
+
+    PushExporter &operator=(const PushExporter &) = delete;
+
+    ~PushExporter();
+
+public:
+    // "statsd://host:port" or "influx://host:port" (port defaults to 8125
+    // or 8089), and comma separated fnmatch() patterns of the series to
+    // send, nullptr for all.  Starts the thread; false with a message in
+    // error if the address won't do.
+    bool start(const char *url, const char *select, std::string &error);
+
+    bool running() const { return fd >= 0; }
+
+    // hand snapshot to the thread
+    void publish(const Snapshot &snapshot);
+
+protected:
+    struct Batch {
+        uint64_t time_ns{};
+        std::string names; // the names, end to end
+        struct Value {
+            uint32_t offset, length; // in names
+            float value;
+        };
+        std::vector<Value> values;
+    };
+
+    Format format{STATSD};
+    int fd{-1}; // connected UDP socket
+    std::string host; // this one, for the names or tags
+    std::vector<std::string> patterns;
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool ready{false}, stopping{false};
+    Batch pending, sending; // pending is filled under lock, sending by the thread alone
+
+    // datagrams being packed
+    char datagrams[PUSH_BATCH][PUSH_DATAGRAM_SIZE]{};
+    size_t lengths[PUSH_BATCH]{};
+    int used{0};
+
+    bool selected(const std::string &name) const;
+
+    void run();
+
+    void send(const Batch &batch);
+
+    // room for n more bytes in the current datagram, starting another if need be
+    char *reserve(size_t n);
+
+    void flush();
+
+    void send_statsd(const Batch &batch);
+
+    void send_influx(const Batch &batch);
+};
+
+extern PushExporter pushExporter;
+
+#endif //CCTOP_PUSHEXPORTER_H
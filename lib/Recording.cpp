@@ -0,0 +1,500 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Recording.h"
+#include "History.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static const uint8_t FRAME_KEY = 'K', FRAME_DELTA = 'D';
+
+// which of a process' fields follow its pid in a frame
+enum {
+    CHANGED_NAME = 1 << 0,
+    CHANGED_RUID = 1 << 1,
+    CHANGED_CPU = 1 << 2,
+    CHANGED_DELAY = 1 << 3,
+    CHANGED_CSW = 1 << 4,
+    CHANGED_ICSW = 1 << 5,
+};
+
+// what a process that wasn't in the last frame is coded against
+static const RecordedProcess NO_PROCESS{};
+
+static uint64_t zigzag(int64_t v) {
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+static void put_varint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+        out += char(v | 0x80);
+        v >>= 7;
+    }
+    out += char(v);
+}
+
+static void put_string(std::string &out, const std::string &s) {
+    put_varint(out, s.size());
+    out += s;
+}
+
+// series values are kept in milli-units; 0 is a gap, anything else the change + 1
+static uint64_t value_code(float value, int64_t &last) {
+    if (std::isnan(value)) {
+        return 0;
+    }
+    auto q = int64_t(std::llround(double(value) * 1000));
+    uint64_t code = zigzag(q - last) + 1;
+    last = q;
+    return code;
+}
+
+// Reads from a frame body; any overrun sets failed and reads zeroes from then on.
+struct Cursor {
+    const uint8_t *p, *end;
+    bool failed{false};
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t b = *p++;
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return v;
+            }
+        }
+        failed = true;
+        p = end;
+        return 0;
+    }
+
+    int64_t signed_varint() { return unzigzag(varint()); }
+
+    uint8_t byte() {
+        if (p < end) {
+            return *p++;
+        }
+        failed = true;
+        return 0;
+    }
+
+    void string(std::string &s) {
+        uint64_t n = varint();
+        if (n > uint64_t(end - p)) {
+            failed = true;
+            p = end;
+            n = 0;
+        }
+        s.assign((const char *) p, size_t(n));
+        p += n;
+    }
+};
+
+// the frame's time, as the writer coded it; last_* carry the delta of deltas
+static uint64_t frame_time(Cursor &c, uint8_t type, uint64_t &last_ms, int64_t &last_step) {
+    if (type == FRAME_KEY) {
+        last_ms = c.varint();
+        last_step = 0;
+    } else {
+        last_step += c.signed_varint();
+        last_ms += uint64_t(last_step);
+    }
+    return last_ms;
+}
+
+RecordingWriter::~RecordingWriter() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool RecordingWriter::open(const char *path) {
+    fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0) {
+        return false;
+    }
+    if (st.st_size == 0) {
+        if (::write(fd, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != ssize_t(sizeof(RECORDING_MAGIC))) {
+            return false;
+        }
+        return true;
+    }
+    // index what's there, so a frame left half written goes
+    RecordingReader existing;
+    if (!existing.open(path)) {
+        return false;
+    }
+    size_t end = sizeof(RECORDING_MAGIC);
+    if (existing.frames()) {
+        end = existing.end_of(existing.frames() - 1);
+    }
+    if (off_t(end) != st.st_size && ftruncate(fd, off_t(end)) < 0) {
+        return false;
+    }
+    return lseek(fd, 0, SEEK_END) >= 0;
+}
+
+void RecordingWriter::begin(const Snapshot &snapshot) {
+    key = frames % RECORDING_KEYFRAME_INTERVAL == 0;
+    body.clear();
+    current.clear();
+    if (key) {
+        series_ids.clear();
+        series_values.clear();
+        name_ids.clear();
+        spelled.clear();
+        spelled_before = 0;
+        previous.clear();
+    }
+    uint64_t ms = snapshot.time_ns / 1000000;
+    body += char(key ? FRAME_KEY : FRAME_DELTA);
+    if (key) {
+        put_varint(body, ms);
+        last_step = 0;
+    } else {
+        auto step = int64_t(ms - last_ms);
+        put_varint(body, zigzag(step - last_step));
+        last_step = step;
+    }
+    last_ms = ms;
+
+    // names first, so the values can refer to them
+    size_t count = 0;
+    for (const auto &field: snapshot.fields) {
+        if (!series_ids.count(*field.name)) {
+            count++;
+        }
+    }
+    put_varint(body, count);
+    for (const auto &field: snapshot.fields) {
+        if (series_ids.emplace(*field.name, uint32_t(series_ids.size())).second) {
+            put_string(body, *field.name);
+            series_values.push_back(0);
+        }
+    }
+    put_varint(body, snapshot.fields.size());
+    int64_t last_id = -1;
+    for (const auto &field: snapshot.fields) {
+        uint32_t id = series_ids[*field.name];
+        put_varint(body, zigzag(int64_t(id) - last_id - 1));
+        put_varint(body, value_code(field.value, series_values[id]));
+        last_id = id;
+    }
+}
+
+void RecordingWriter::process(const RecordedProcess &p, const char *name) {
+    current.push_back(p);
+    scratch.assign(name);
+    auto it = name_ids.find(scratch);
+    if (it == name_ids.end()) {
+        // spelled out by end(); ids follow on from the last
+        it = name_ids.emplace(scratch, uint32_t(name_ids.size())).first;
+        spelled.push_back(&it->first);
+    }
+    current.back().name = it->second;
+}
+
+bool RecordingWriter::end() {
+    // names this frame uses for the first time
+    put_varint(body, spelled.size() - spelled_before);
+    for (size_t i = spelled_before; i < spelled.size(); i++) {
+        put_string(body, *spelled[i]);
+    }
+    spelled_before = spelled.size();
+
+    std::sort(current.begin(), current.end(), [](const RecordedProcess &a, const RecordedProcess &b) {
+        return a.pid < b.pid;
+    });
+    // processes from the last frame that aren't in this one have exited
+    for (const auto &p: current) {
+        auto it = previous.find(p.pid);
+        if (it != previous.end()) {
+            it->second.frame = frames;
+        }
+    }
+    for (auto it = previous.begin(); it != previous.end();) {
+        if (it->second.frame != frames) {
+            exited.push_back(it->first);
+            it = previous.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::sort(exited.begin(), exited.end());
+    put_varint(body, exited.size());
+    uint32_t last_pid = 0;
+    for (uint32_t pid: exited) {
+        put_varint(body, pid - last_pid);
+        last_pid = pid;
+    }
+    exited.clear();
+
+    // then the ones that started or changed
+    size_t count = 0;
+    for (const auto &p: current) {
+        auto it = previous.find(p.pid);
+        if (it == previous.end() || !(it->second.p == p)) {
+            count++;
+        }
+    }
+    put_varint(body, count);
+    last_pid = 0;
+    for (const auto &p: current) {
+        auto it = previous.find(p.pid);
+        const RecordedProcess &was = it == previous.end() ? NO_PROCESS : it->second.p;
+        if (it != previous.end() && was == p) {
+            continue;
+        }
+        uint8_t mask = (p.name != was.name ? CHANGED_NAME : 0) |
+                       (p.ruid != was.ruid ? CHANGED_RUID : 0) |
+                       (p.cpu != was.cpu ? CHANGED_CPU : 0) |
+                       (p.delay != was.delay ? CHANGED_DELAY : 0) |
+                       (p.csw != was.csw ? CHANGED_CSW : 0) |
+                       (p.icsw != was.icsw ? CHANGED_ICSW : 0);
+        put_varint(body, p.pid - last_pid);
+        last_pid = p.pid;
+        body += char(mask);
+        if (mask & CHANGED_NAME) {
+            put_varint(body, zigzag(int64_t(p.name) - int64_t(was.name)));
+        }
+        if (mask & CHANGED_RUID) {
+            put_varint(body, zigzag(int64_t(p.ruid) - int64_t(was.ruid)));
+        }
+        if (mask & CHANGED_CPU) {
+            put_varint(body, zigzag(int64_t(p.cpu) - was.cpu));
+        }
+        if (mask & CHANGED_DELAY) {
+            put_varint(body, zigzag(int64_t(p.delay) - was.delay));
+        }
+        if (mask & CHANGED_CSW) {
+            put_varint(body, zigzag(int64_t(p.csw) - was.csw));
+        }
+        if (mask & CHANGED_ICSW) {
+            put_varint(body, zigzag(int64_t(p.icsw) - was.icsw));
+        }
+    }
+    for (const auto &p: current) {
+        previous[p.pid] = {p, frames};
+    }
+    frames++;
+
+    length_size = 0;
+    for (uint64_t v = body.size(); ; v >>= 7) {
+        length[length_size++] = char(v >= 0x80 ? (v & 0x7f) | 0x80 : v);
+        if (v < 0x80) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        // kept for frame()
+        return true;
+    }
+    // length and body in one write, so a reader never sees half a frame
+    iovec iov[2] = {{length, length_size}, {(void *) body.data(), body.size()}};
+    ssize_t written = writev(fd, iov, 2);
+    if (written != ssize_t(length_size + body.size())) {
+        if (written >= 0) {
+            errno = ENOSPC;
+        }
+        // the next frame can't be a delta against one that isn't there
+        frames = 0;
+        return false;
+    }
+    return true;
+}
+
+void RecordingWriter::frame(std::string &out) const {
+    out.append(length, length_size);
+    out += body;
+}
+
+RecordingReader::~RecordingReader() {
+    if (data) {
+        munmap((void *) data, size);
+    }
+}
+
+bool RecordingReader::open(const char *path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+    size = size_t(st.st_size);
+    if (size < sizeof(RECORDING_MAGIC)) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    void *m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        return false;
+    }
+    data = (const uint8_t *) m;
+    if (memcmp(data, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        errno = EINVAL;
+        return false;
+    }
+
+    // lengths and times only; a frame that runs past the end was cut short
+    Cursor file{data + sizeof(RECORDING_MAGIC), data + size};
+    uint64_t ms = 0;
+    int64_t step = 0;
+    size_t key = 0;
+    while (file.p < file.end) {
+        uint64_t length = file.varint();
+        if (file.failed || length == 0 || length > uint64_t(file.end - file.p)) {
+            break;
+        }
+        Cursor frame{file.p, file.p + length};
+        uint8_t type = frame.byte();
+        if (type != FRAME_KEY && (type != FRAME_DELTA || index.empty())) {
+            break;
+        }
+        if (type == FRAME_KEY) {
+            key = index.size();
+        }
+        uint64_t time = frame_time(frame, type, ms, step);
+        if (frame.failed) {
+            break;
+        }
+        index.push_back({size_t(file.p - data), size_t(length), time, key});
+        file.p += length;
+    }
+    last = index.size();
+    return true;
+}
+
+bool RecordingReader::read(size_t n) {
+    if (n >= index.size()) {
+        return false;
+    }
+    const Entry &e = index[n];
+    if (e.key != n && (last == index.size() || last + 1 != n)) {
+        return false;
+    }
+    last = index.size();
+    if (!decode(data + e.offset, e.length)) {
+        return false;
+    }
+    last = n;
+    return true;
+}
+
+bool RecordingReader::decode(const uint8_t *frame, size_t length) {
+    Cursor c{frame, frame + length};
+    uint8_t type = c.byte();
+    bool key = type == FRAME_KEY;
+    if (!key && (type != FRAME_DELTA || !decoded)) {
+        return false;
+    }
+    // until this one is through, there's nothing to go on from
+    decoded = false;
+    frame_time(c, type, last_ms, last_step);
+    if (key) {
+        series_names.clear();
+        series_values.clear();
+        names.clear();
+        processes.clear();
+    }
+
+    for (uint64_t count = c.varint(); count > 0 && !c.failed; count--) {
+        series_names.emplace_back();
+        c.string(series_names.back());
+        series_values.push_back(0);
+    }
+    values.clear();
+    int64_t id = -1;
+    for (uint64_t count = c.varint(); count > 0 && !c.failed; count--) {
+        id += c.signed_varint() + 1;
+        uint64_t code = c.varint();
+        if (id < 0 || size_t(id) >= series_values.size()) {
+            return false;
+        }
+        float value = HISTORY_GAP;
+        if (code) {
+            series_values[id] += unzigzag(code - 1);
+            value = float(double(series_values[id]) / 1000);
+        }
+        values.emplace_back(uint32_t(id), value);
+    }
+
+    for (uint64_t count = c.varint(); count > 0 && !c.failed; count--) {
+        names.emplace_back();
+        c.string(names.back());
+    }
+    uint32_t pid = 0;
+    for (uint64_t count = c.varint(); count > 0 && !c.failed; count--) {
+        pid += uint32_t(c.varint());
+        processes.erase(pid);
+    }
+    pid = 0;
+    for (uint64_t count = c.varint(); count > 0 && !c.failed; count--) {
+        pid += uint32_t(c.varint());
+        RecordedProcess &p = processes[pid];
+        p.pid = pid;
+        uint8_t mask = c.byte();
+        if (mask & CHANGED_NAME) {
+            p.name = uint32_t(p.name + c.signed_varint());
+        }
+        if (mask & CHANGED_RUID) {
+            p.ruid = uint32_t(p.ruid + c.signed_varint());
+        }
+        if (mask & CHANGED_CPU) {
+            p.cpu = int32_t(p.cpu + c.signed_varint());
+        }
+        if (mask & CHANGED_DELAY) {
+            p.delay = int32_t(p.delay + c.signed_varint());
+        }
+        if (mask & CHANGED_CSW) {
+            p.csw = int32_t(p.csw + c.signed_varint());
+        }
+        if (mask & CHANGED_ICSW) {
+            p.icsw = int32_t(p.icsw + c.signed_varint());
+        }
+        if (p.name >= names.size()) {
+            return false;
+        }
+    }
+    if (c.failed) {
+        return false;
+    }
+    decoded = true;
+    return true;
+}
@@ -0,0 +1,219 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_RECORDING_H
+#define CCTOP_RECORDING_H
+
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a full frame every this many, so a seek never decodes more than this
+const uint32_t RECORDING_KEYFRAME_INTERVAL = 600;
+
+// bytes in the largest frame a stream (-c) will take; a keyframe with every
+// series named and a full process table is a small fraction of this
+const uint64_t RECORDING_MAX_FRAME = 16 * 1024 * 1024;
+
+// what a recording, or a stream of frames (-d), starts with
+const char RECORDING_MAGIC[8] = {'C', 'C', 'T', 'O', 'P', 'R', 'C', '1'};
+
+// what the process list shows for a process, in the units it shows them
+struct RecordedProcess {
+    uint32_t pid{};
+    uint32_t ruid{};
+    uint32_t name{};  // id in the frame's name dictionary
+    int32_t cpu{};    // tenths of a percent of one core
+    int32_t delay{};  // scheduling delay, tenths of a ms per second
+    int32_t csw{};    // context switches per second
+    int32_t icsw{-1}; // involuntary ones; -1 where the kernel doesn't split them
+
+    bool operator==(const RecordedProcess &o) const {
+        return name == o.name && ruid == o.ruid && cpu == o.cpu && delay == o.delay && csw == o.csw && icsw == o.icsw;
+    }
+};
+
+//
+// A recording is a magic number followed by frames, each a varint length
+// and a body: the wall clock time, every non-process series in history()
+// and the process table.
+//
+// Keyframes stand alone.  Every other frame is coded against the one
+// before it: the time as a delta of deltas, series values (fixed point,
+// milli-units) as the change from the last value, and only the processes
+// that started, exited or changed, their fields again as changes.  The
+// rates cctop records are themselves deltas of the kernel's counters, so
+// steady activity costs a byte or so per value and an idle process costs
+// nothing.  Series and process names go into dictionaries that start
+// over at each keyframe; a name is spelled out the first time a frame
+// uses it.
+//
+// A writer that was never opened keeps each frame for frame() instead,
+// for streaming to viewers.
+//
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+
+    RecordingWriter(const RecordingWriter &) = delete;
+
+    RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+    ~RecordingWriter();
+
+public:
+    // Append to path, creating it; false (with errno) if it can't be opened
+    // or isn't a recording.  A frame cut short by a crash is dropped first.
+    bool open(const char *path);
+
+    // one frame: begin(), process() for each process, end()
+    void begin(const Snapshot &snapshot);
+
+    void process(const RecordedProcess &p, const char *name);
+
+    // false (with errno) if the frame couldn't be written
+    bool end();
+
+    // the frame begun last is a keyframe
+    bool keyframe() const { return key; }
+
+    // append the frame end() finished, length and all, to out
+    void frame(std::string &out) const;
+
+    // make the next frame a keyframe, for a reader starting there
+    void restart() { frames = 0; }
+
+protected:
+    int fd{-1};
+    uint64_t frames{0};   // this session
+    bool key{true};       // the frame being built is a keyframe
+    std::string body;     // reused from frame to frame
+    char length[10]{};    // body's length as a varint
+    size_t length_size{0};
+    uint64_t last_ms{0};
+    int64_t last_step{0};
+
+    std::unordered_map<std::string, uint32_t> series_ids;
+    std::vector<int64_t> series_values; // by id, fixed point
+    std::unordered_map<std::string, uint32_t> name_ids;
+    std::vector<const std::string *> spelled; // name_ids' keys, by id
+    size_t spelled_before{0};                 // how many earlier frames spelled out
+    std::string scratch;
+
+    struct Previous {
+        RecordedProcess p;
+        uint64_t frame;
+    };
+    std::vector<RecordedProcess> current;
+    std::unordered_map<uint32_t, Previous> previous;
+    std::vector<uint32_t> exited;
+};
+
+//
+// Reads a recording back a frame at a time.  open() maps the file and
+// indexes every frame by skipping from length to length, so getting to
+// any frame is a jump to its keyframe and at most
+// RECORDING_KEYFRAME_INTERVAL frames decoded from there.
+//
+class RecordingReader {
+public:
+    RecordingReader() = default;
+
+    RecordingReader(const RecordingReader &) = delete;
+
+    RecordingReader &operator=(const RecordingReader &) = delete;
+
+    ~RecordingReader();
+
+public:
+    // false (with errno) if it can't be read or isn't a recording
+    bool open(const char *path);
+
+    size_t frames() const { return index.size(); }
+
+    // wall clock time of frame n, in ms
+    uint64_t time_ms(size_t n) const { return index[n].time_ms; }
+
+    // the keyframe that frame n is decoded from
+    size_t keyframe(size_t n) const { return index[n].key; }
+
+    // Decode frame n.  Unless it's a keyframe, the frame before it has to
+    // have been the last one read.  False if the frame is damaged.
+    bool read(size_t n);
+
+    // index of the last frame read, frames() if none
+    size_t position() const { return last; }
+
+    // Decode a frame body that isn't in the file, e.g. one a daemon sent.
+    // Unless it's a keyframe, the last one decoded has to have been the
+    // frame before it.  False if it's damaged or out of turn.
+    bool decode(const uint8_t *frame, size_t length);
+
+    // wall clock time of the frame last decoded, in ms
+    uint64_t decoded_ms() const { return last_ms; }
+
+    // file offset just past frame n
+    size_t end_of(size_t n) const { return index[n].offset + index[n].length; }
+
+public:
+    // the frame last read
+    std::vector<std::string> series_names;      // by id
+    std::vector<std::pair<uint32_t, float>> values; // series id, value (HISTORY_GAP for none)
+    std::vector<std::string> names;             // process names, by id
+    std::map<uint32_t, RecordedProcess> processes;
+
+    // Call f(device, measurement, value) for each series in the frame last
+    // read named group/device/measurement.  The device is everything
+    // between the first slash and the last, so it can be a mount point.
+    template<typename F>
+    void each_device(const char *group, F f) const {
+        size_t skip = strlen(group) + 1;
+        for (const auto &v: values) {
+            const std::string &name = series_names[v.first];
+            size_t slash = name.rfind('/');
+            if (slash == std::string::npos || slash < skip || name.compare(0, skip - 1, group) != 0 ||
+                name[skip - 1] != '/') {
+                continue;
+            }
+            f(name.substr(skip, slash - skip), name.c_str() + slash + 1, v.second);
+        }
+    }
+
+protected:
+    struct Entry {
+        size_t offset, length;
+        uint64_t time_ms;
+        size_t key;
+    };
+    const uint8_t *data{nullptr};
+    size_t size{0};
+    std::vector<Entry> index;
+    size_t last{0};
+    bool decoded{false}; // there's a frame to decode the next delta against
+    uint64_t last_ms{0};
+    int64_t last_step{0};
+    std::vector<int64_t> series_values;
+};
+
+#endif //CCTOP_RECORDING_H
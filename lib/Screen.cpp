@@ -0,0 +1,244 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Screen.h"
+#include <algorithm>
+#include <cstdio>
+
+static int glyph_width(wchar_t c) {
+    if (c < 0x7f) {
+        return 1;
+    }
+    int w = ::wcwidth(c);
+    // unprintable in this locale; still takes a cell on any sane terminal
+    return w < 0 ? 1 : w;
+}
+
+static void append_utf8(std::string &out, wchar_t wc) {
+    auto c = uint32_t(wc);
+    if (c < 0x80) {
+        out += char(c);
+    } else if (c < 0x800) {
+        out += char(0xc0 | (c >> 6));
+        out += char(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+        out += char(0xe0 | (c >> 12));
+        out += char(0x80 | ((c >> 6) & 0x3f));
+        out += char(0x80 | (c & 0x3f));
+    } else {
+        out += char(0xf0 | (c >> 18));
+        out += char(0x80 | ((c >> 12) & 0x3f));
+        out += char(0x80 | ((c >> 6) & 0x3f));
+        out += char(0x80 | (c & 0x3f));
+    }
+}
+
+void Screen::blank(Cell *cells, int n) {
+    for (int i = 0; i < n; i++) {
+        cells[i] = Cell();
+    }
+}
+
+void Screen::resize(uint16_t w, uint16_t h) {
+    width = w;
+    height = h;
+    front.assign(size_t(w) * h, Cell());
+    back.assign(size_t(w) * h, Cell());
+    viewport(0, 0, w, h);
+    invalidate();
+}
+
+void Screen::viewport(uint16_t top, uint16_t left, uint16_t w, uint16_t h) {
+    // keep it on the screen
+    view.top = std::min(top, height);
+    view.left = std::min(left, width);
+    view.width = std::min(w, uint16_t(width - view.left));
+    view.height = std::min(h, uint16_t(height - view.top));
+    row = column = 0;
+}
+
+void Screen::move(uint16_t r, uint16_t c) {
+    row = r;
+    column = c;
+}
+
+void Screen::clear() {
+    for (uint16_t r = 0; r < view.height; r++) {
+        blank(view_row(r), view.width);
+    }
+    row = column = 0;
+}
+
+void Screen::clear_eol() {
+    if (row < view.height && column < view.width) {
+        Cell *cells = view_row(row);
+        // don't leave half of a double width glyph behind
+        if (column > 0 && cells[column].glyph == 0) {
+            cells[column - 1] = Cell();
+        }
+        blank(&cells[column], view.width - column);
+    }
+}
+
+void Screen::newline() {
+    clear_eol();
+    row++;
+    column = 0;
+}
+
+void Screen::put(wchar_t c) {
+    if (c < 0x20) {
+        switch (c) {
+            case L'\n':
+                newline();
+                break;
+            case L'\r':
+                column = 0;
+                break;
+            case L'\t':
+                do {
+                    put(L' ');
+                } while (column < view.width && column % 8);
+                break;
+            default:
+                break;
+        }
+        return;
+    }
+
+    int w = glyph_width(c);
+    if (row >= view.height || column + w > view.width || w == 0) {
+        column += w;
+        return;
+    }
+    Cell *cells = view_row(row);
+    if (column > 0 && cells[column].glyph == 0) {
+        // overwriting the right half of a double width glyph
+        cells[column - 1].glyph = L' ';
+    }
+    if (column + w < view.width && cells[column + w].glyph == 0) {
+        // and its left half
+        cells[column + w].glyph = L' ';
+    }
+    Cell &cell = cells[column];
+    cell = pen;
+    cell.glyph = c;
+    if (w == 2) {
+        cells[column + 1] = pen;
+        cells[column + 1].glyph = 0;
+    }
+    column += w;
+}
+
+int Screen::puts(const char *s, int max) {
+    auto *p = (const uint8_t *) s;
+    int n = 0;
+    for (; *p && (max <= 0 || n < max); n++) {
+        uint32_t c = *p++;
+        if (c >= 0x80) {
+            int more = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : c >= 0xc0 ? 1 : 0;
+            c &= 0x3f >> more;
+            for (; more && (*p & 0xc0) == 0x80; more--) {
+                c = (c << 6) | (*p++ & 0x3f);
+            }
+            if (more) {
+                // truncated or invalid sequence
+                c = L'?';
+            }
+        }
+        put(wchar_t(c));
+    }
+    return n;
+}
+
+int Screen::glyphs(const char *s, int max) {
+    int n = 0;
+    for (auto *p = (const uint8_t *) s; *p && (max <= 0 || n < max); p++) {
+        // count everything but continuation bytes
+        if ((*p & 0xc0) != 0x80) {
+            n++;
+        }
+    }
+    return n;
+}
+
+void Screen::putws(const wchar_t *s) {
+    while (*s) {
+        put(*s++);
+    }
+}
+
+static void append_sgr(std::string &out, const Cell &cell) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "\x1b[0%s%s%s%s",
+                     cell.attr & CELL_BOLD ? ";1" : "",
+                     cell.attr & CELL_UNDERLINE ? ";4" : "",
+                     cell.attr & CELL_BLINK ? ";5" : "",
+                     cell.attr & CELL_INVERSE ? ";7" : "");
+    if (cell.attr & CELL_COLOR) {
+        n += snprintf(&buf[n], sizeof(buf) - n, ";%d;%d", 30 + cell.fg, 40 + cell.bg);
+    }
+    out.append(buf, n);
+    out += 'm';
+}
+
+void Screen::render(std::string &out) {
+    char buf[32];
+    int tr = -1, tc = -1; // terminal cursor, -1 if unknown
+    Cell style;           // terminal's current attributes
+    bool have_style = false;
+
+    if (!valid) {
+        out += "\x1b[0m\x1b[H\x1b[2J";
+        tr = tc = 0;
+        have_style = true;
+    }
+    flush([&](uint16_t r, uint16_t c, const Cell *cells, int n) {
+        if (r == tr && c == tc) {
+            // already there
+        } else if (r == tr && c > tc) {
+            out.append(buf, snprintf(buf, sizeof(buf), "\x1b[%dC", c - tc));
+        } else if (tr >= 0 && r == tr + 1 && c == 0) {
+            out += "\r\n";
+        } else {
+            out.append(buf, snprintf(buf, sizeof(buf), "\x1b[%d;%dH", r + 1, c + 1));
+        }
+        for (int i = 0; i < n; i++) {
+            const Cell &cell = cells[i];
+            if (cell.glyph == 0) {
+                continue;
+            }
+            if (!have_style || !cell.same_style(style)) {
+                append_sgr(out, cell);
+                style = cell;
+                have_style = true;
+            }
+            append_utf8(out, cell.glyph);
+        }
+        tr = r;
+        tc = c + n;
+        if (tc < width && back[r * width + tc].glyph == 0) {
+            // ended on the left half of a double width glyph
+            tc++;
+        }
+    });
+    if (have_style && style.attr) {
+        out += "\x1b[0m";
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SCREEN_H
+#define CCTOP_SCREEN_H
+
+#include <cstdint>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+// cell attributes
+const uint8_t CELL_BOLD = 0x01;
+const uint8_t CELL_UNDERLINE = 0x02;
+const uint8_t CELL_BLINK = 0x04;
+const uint8_t CELL_INVERSE = 0x08;
+const uint8_t CELL_COLOR = 0x10; // fg/bg apply; otherwise the terminal's default colors
+
+// unchanged cells between two changed ones that are cheaper to resend than
+// to skip with a cursor movement
+const int SCREEN_MERGE_GAP = 4;
+
+struct Cell {
+    wchar_t glyph{L' '}; // 0 for the right half of a double width glyph
+    uint8_t attr{}, fg{}, bg{};
+
+    bool same_style(const Cell &o) const {
+        return attr == o.attr && (!(attr & CELL_COLOR) || (fg == o.fg && bg == o.bg));
+    }
+
+    bool operator==(const Cell &o) const { return glyph == o.glyph && same_style(o); }
+
+    bool operator!=(const Cell &o) const { return !(*this == o); }
+};
+
+//
+// Off screen grid of cells that the panels draw into.
+//
+// back is the frame being drawn, front is what the terminal is showing.
+// Each frame only the cells that differ are sent, so a mostly static
+// screen costs a few dozen bytes rather than a full repaint.
+//
+class Screen {
+public:
+    uint16_t width{}, height{};
+    uint16_t row{}, column{}; // drawing cursor, relative to the viewport
+    Cell pen;                 // style for cells drawn next (glyph unused)
+    uint32_t changed{};       // cells sent by the last flush
+
+public:
+    void resize(uint16_t w, uint16_t h);
+
+    // terminal contents are unknown (startup, resize, ^L); repaint everything
+    void invalidate() { valid = false; }
+
+    bool is_valid() const { return valid; }
+
+    // Restrict drawing to a rectangle; move(0, 0) is its top left corner and
+    // anything outside it is clipped.  resize() resets it to the whole screen.
+    void viewport(uint16_t top, uint16_t left, uint16_t w, uint16_t h);
+
+    uint16_t view_width() const { return view.width; }
+
+    uint16_t view_height() const { return view.height; }
+
+public:
+    // drawing; anything past the right or bottom edge of the viewport is clipped
+    void move(uint16_t r, uint16_t c);
+
+    void clear();
+
+    void clear_eol();
+
+    void newline();
+
+    void put(wchar_t c);
+
+    // draw at most max glyphs (0 for all) of utf8, return # drawn
+    int puts(const char *utf8, int max = 0);
+
+    // # of glyphs in utf8, up to max (0 for all)
+    static int glyphs(const char *utf8, int max = 0);
+
+    void putws(const wchar_t *s);
+
+public:
+    // Call f(row, column, cells, n) for each run of changed cells, then
+    // consider them sent.  Runs never span rows.
+    template<typename F>
+    void flush(F f) {
+        changed = 0;
+        if (!valid) {
+            // the caller has cleared the terminal
+            blank(front.data(), int(front.size()));
+        }
+        for (uint16_t r = 0; r < height; r++) {
+            Cell *b = &back[r * width], *fr = &front[r * width];
+            int c = 0;
+            while (c < width) {
+                if (b[c] == fr[c]) {
+                    c++;
+                    continue;
+                }
+                int start = c, end = c + 1, gap = 0;
+                for (int i = end; i < width; i++) {
+                    if (b[i] != fr[i]) {
+                        end = i + 1;
+                        gap = 0;
+                    } else if (++gap > SCREEN_MERGE_GAP) {
+                        break;
+                    }
+                }
+                // don't start on the right half of a double width glyph
+                if (start > 0 && b[start].glyph == 0) {
+                    start--;
+                }
+                f(r, uint16_t(start), &b[start], end - start);
+                for (int i = start; i < end; i++) {
+                    fr[i] = b[i];
+                }
+                changed += end - start;
+                c = end;
+            }
+        }
+        valid = true;
+    }
+
+    // append the escape sequences that bring an ANSI terminal up to date
+    void render(std::string &out);
+
+protected:
+    std::vector<Cell> front, back;
+    bool valid{false};
+
+    struct {
+        uint16_t top, left, width, height;
+    } view{};
+
+    // first cell of row r of the viewport
+    Cell *view_row(uint16_t r) { return &back[size_t(view.top + r) * width + view.left]; }
+
+    void blank(Cell *cells, int n);
+};
+
+#endif //CCTOP_SCREEN_H
@@ -0,0 +1,144 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "SharedPublisher.h"
+#include <cerrno>
+#include <csignal>
+#include <new>
+
+// the pid writing the segment called name, 0 if there's none (or it isn't one of ours)
+static pid_t segment_writer(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st{};
+    void *m = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(SharedSnapshot)) {
+        m = mmap(nullptr, sizeof(SharedSnapshot), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (m == MAP_FAILED) {
+        return 0;
+    }
+    const auto *s = (const SharedSnapshot *) m;
+    pid_t writer = s->magic == SHARED_MAGIC ? pid_t(s->writer) : 0;
+    munmap(m, sizeof(SharedSnapshot));
+    return writer;
+}
+
+SharedPublisher::~SharedPublisher() {
+    if (shared) {
+        munmap(shared, sizeof(SharedSnapshot));
+        // readers that have it mapped keep it; new ones find nothing, not stale figures.
+        // Unless someone removed it and another cctop has the name now.
+        if (segment_writer(name.c_str()) == getpid()) {
+            shm_unlink(name.c_str());
+        }
+    }
+}
+
+bool SharedPublisher::open(const char *n) {
+    name = n;
+    pid_t writer = segment_writer(n);
+    if (writer > 0 && writer != getpid() && (kill(writer, 0) == 0 || errno == EPERM)) {
+        // another cctop is publishing there
+        errno = EEXIST;
+        return false;
+    }
+    // one left by a cctop that died; MacOS won't resize an existing segment anyway
+    shm_unlink(n);
+    int fd = shm_open(n, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SharedSnapshot)) < 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(n);
+        errno = e;
+        return false;
+    }
+    void *m = mmap(nullptr, sizeof(SharedSnapshot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        int e = errno;
+        shm_unlink(n);
+        errno = e;
+        return false;
+    }
+    // fresh pages are zero, so sequence starts even and there's nothing in it
+    shared = new(m) SharedSnapshot;
+    shared->version = SHARED_VERSION;
+    shared->size = sizeof(SharedSnapshot);
+    shared->writer = uint32_t(getpid());
+    // last, so a reader that checks it sees the rest
+    std::atomic_thread_fence(std::memory_order_release);
+    shared->magic = SHARED_MAGIC;
+    return true;
+}
+
+void SharedPublisher::publish(const Snapshot &snapshot, const Processes &busiest) {
+    if (!shared) {
+        return;
+    }
+    uint64_t sequence = shared->sequence.load(std::memory_order_relaxed);
+    // odd: readers that start now wait, ones already reading will retry
+    shared->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    shared->time_ns = snapshot.time_ns;
+    shared->updates++;
+    uint32_t n = 0;
+    for (const auto &field: snapshot.fields) {
+        if (n == SHARED_MAX_METRICS) {
+            break;
+        }
+        // a name that doesn't fit is left out rather than cut into another's
+        if (field.name->size() >= SHARED_METRIC_NAME) {
+            continue;
+        }
+        SharedMetric &m = shared->metrics[n++];
+        memcpy(m.name, field.name->c_str(), field.name->size() + 1);
+        m.value = field.value;
+    }
+    shared->metric_count = n;
+
+    n = 0;
+    for (const auto &it: busiest) {
+        if (n == SHARED_MAX_PROCESSES) {
+            break;
+        }
+        const RecordedProcess &r = it.first;
+        SharedProcess &p = shared->processes[n++];
+        p.pid = r.pid;
+        p.ruid = r.ruid;
+        p.cpu = float(r.cpu) / 10;
+        p.delay = float(r.delay) / 10;
+        p.csw = float(r.csw);
+        p.icsw = float(r.icsw);
+        strncpy(p.name, it.second, SHARED_PROCESS_NAME - 1);
+        p.name[SHARED_PROCESS_NAME - 1] = '\0';
+    }
+    shared->process_count = n;
+
+    shared->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+SharedPublisher sharedPublisher;
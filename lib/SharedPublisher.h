@@ -0,0 +1,67 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SHAREDPUBLISHER_H
+#define CCTOP_SHAREDPUBLISHER_H
+
+#include "Recording.h"
+#include "SharedSnapshot.h"
+#include "Snapshot.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// --shm: keeps the latest snapshot in a POSIX shared memory segment laid
+// out as SharedSnapshot.h says, for other programs on the host to read
+// instead of sampling the kernel again.  Each publish() is a seqlock
+// write: readers never block cctop, and cctop never waits for them.
+// The segment is removed when cctop exits; one a live cctop is still
+// publishing in is left alone.
+//
+class SharedPublisher {
+public:
+    SharedPublisher() = default;
+
+    SharedPublisher(const SharedPublisher &) = delete;
+
+    SharedPublisher &operator=(const SharedPublisher &) = delete;
+
+    ~SharedPublisher();
+
+public:
+    // create the segment, or take over one left by a cctop that's gone; false
+    // (with errno, EEXIST if another cctop has it) if it can't be
+    bool open(const char *name);
+
+    bool publishing() const { return shared != nullptr; }
+
+    // the busiest processes as the process list shows them, with their names
+    using Processes = std::vector<std::pair<RecordedProcess, const char *>>;
+
+    void publish(const Snapshot &snapshot, const Processes &busiest);
+
+protected:
+    SharedSnapshot *shared{nullptr};
+    std::string name;
+};
+
+extern SharedPublisher sharedPublisher;
+
+#endif //CCTOP_SHAREDPUBLISHER_H
@@ -0,0 +1,197 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SHAREDSNAPSHOT_H
+#define CCTOP_SHAREDSNAPSHOT_H
+
+//
+// The layout of the snapshot cctop --shm publishes, and a reader for it.
+// This header stands alone (the standard library and POSIX, nothing of
+// cctop's), so another program can copy it and read cctop's figures
+// with no syscalls after open():
+//
+//   SharedSnapshotReader cctop;
+//   double cpu;
+//   if (cctop.open() && cctop.find("cpu/CPU", &cpu)) ...
+//
+// The segment is versioned with a seqlock: sequence is odd while cctop
+// is writing, and a reader that saw it change has to read again.
+// Metrics are the series cctop keeps ("cpu/CPU", "memory/used",
+// "disk/disk0/read", "net/en0/rx"...) in name order; processes are the
+// busiest by CPU.  The segment is fixed size and in the host's byte
+// order; a version change means a new layout.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char *const SHARED_DEFAULT_NAME = "/cctop";
+
+const uint32_t SHARED_MAGIC = 0x50544343; // "CCTP"
+const uint32_t SHARED_VERSION = 1;
+
+const uint32_t SHARED_MAX_METRICS = 512;
+const uint32_t SHARED_METRIC_NAME = 48;
+const uint32_t SHARED_MAX_PROCESSES = 64;
+const uint32_t SHARED_PROCESS_NAME = 32;
+
+// a reader gives up after this many tries that all raced a write
+const int SHARED_READ_TRIES = 100;
+
+struct SharedMetric {
+    char name[SHARED_METRIC_NAME]; // nul terminated
+    double value;                  // NaN where there was no sample
+};
+
+struct SharedProcess {
+    uint32_t pid;
+    uint32_t ruid;
+    float cpu;   // percent of one core
+    float delay; // scheduling delay, ms per second
+    float csw;   // context switches per second
+    float icsw;  // involuntary ones, -1 where the kernel doesn't split them
+    char name[SHARED_PROCESS_NAME];
+};
+
+struct SharedSnapshot {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size; // sizeof(SharedSnapshot)
+    uint32_t writer; // pid of the cctop writing it
+    std::atomic<uint64_t> sequence;
+    uint64_t time_ns; // wall clock of the sample
+    uint64_t updates; // samples published so far
+    uint32_t metric_count;
+    uint32_t process_count;
+    SharedMetric metrics[SHARED_MAX_METRICS];
+    SharedProcess processes[SHARED_MAX_PROCESSES];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock has to work across processes");
+
+class SharedSnapshotReader {
+public:
+    SharedSnapshotReader() = default;
+
+    SharedSnapshotReader(const SharedSnapshotReader &) = delete;
+
+    SharedSnapshotReader &operator=(const SharedSnapshotReader &) = delete;
+
+    ~SharedSnapshotReader() { close(); }
+
+public:
+    // map the segment; false (with errno) if there's none or it's another layout
+    bool open(const char *name = SHARED_DEFAULT_NAME) {
+        close();
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(SharedSnapshot)) {
+            ::close(fd);
+            errno = EPROTO;
+            return false;
+        }
+        void *m = mmap(nullptr, sizeof(SharedSnapshot), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) {
+            return false;
+        }
+        shared = (const SharedSnapshot *) m;
+        if (shared->magic != SHARED_MAGIC || shared->version != SHARED_VERSION ||
+            shared->size != sizeof(SharedSnapshot)) {
+            close();
+            errno = EPROTO;
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (shared) {
+            munmap((void *) shared, sizeof(SharedSnapshot));
+            shared = nullptr;
+        }
+    }
+
+    // Call f(snapshot) until it has seen a consistent one; f may be run
+    // more than once, and shouldn't keep pointers into the segment.
+    // False if no consistent read could be had.
+    template<typename F>
+    bool read(F f) const {
+        if (!shared) {
+            return false;
+        }
+        for (int i = 0; i < SHARED_READ_TRIES; i++) {
+            uint64_t before = shared->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            f(*shared);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shared->sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // a consistent copy of the whole thing
+    bool copy(SharedSnapshot *out) const {
+        return read([out](const SharedSnapshot &s) {
+            memcpy((void *) out, (const void *) &s, sizeof(s));
+        });
+    }
+
+    // one metric by name; false if it isn't there
+    bool find(const char *name, double *value) const {
+        bool found = false;
+        bool ok = read([&](const SharedSnapshot &s) {
+            found = false;
+            uint32_t n = s.metric_count < SHARED_MAX_METRICS ? s.metric_count : SHARED_MAX_METRICS;
+            for (uint32_t i = 0; i < n; i++) {
+                if (!strncmp(s.metrics[i].name, name, SHARED_METRIC_NAME)) {
+                    *value = s.metrics[i].value;
+                    found = true;
+                    break;
+                }
+            }
+        });
+        return ok && found;
+    }
+
+    // samples published so far; if it stops going up, cctop has stopped
+    uint64_t updates() const {
+        uint64_t n = 0;
+        read([&n](const SharedSnapshot &s) { n = s.updates; });
+        return n;
+    }
+
+protected:
+    const SharedSnapshot *shared{nullptr};
+};
+
+#endif //CCTOP_SHAREDSNAPSHOT_H
@@ -0,0 +1,148 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Snapshot.h"
+#include "Clock.h"
+#include "Format.h"
+#include "History.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+
+void Snapshot::take() {
+    time_ns = realtime_ns();
+    fields.clear();
+    history().each([&](const std::string &name, const Series &series) {
+        if (name.compare(0, 8, "process/") != 0) {
+            fields.push_back({&name, series.latest()});
+        }
+    });
+}
+
+void SnapshotWriter::flush() {
+    const char *p = buffer;
+    while (length > 0 && !failed) {
+        ssize_t n = ::write(fd, p, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        p += n;
+        length -= size_t(n);
+    }
+    length = 0;
+}
+
+void SnapshotWriter::append(const char *s, size_t n) {
+    while (n > 0) {
+        if (length == sizeof(buffer)) {
+            flush();
+        }
+        size_t room = std::min(n, sizeof(buffer) - length);
+        memcpy(&buffer[length], s, room);
+        length += room;
+        s += room;
+        n -= room;
+    }
+}
+
+void SnapshotWriter::append(char c) {
+    if (length == sizeof(buffer)) {
+        flush();
+    }
+    buffer[length++] = c;
+}
+
+void SnapshotWriter::append_string(const std::string &s) {
+    append('"');
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            append('\\');
+            append(c);
+        } else if ((unsigned char) c < 0x20) {
+            char esc[8];
+            append(esc, size_t(snprintf(esc, sizeof(esc), "\\u%04x", c)));
+        } else {
+            append(c);
+        }
+    }
+    append('"');
+}
+
+void SnapshotWriter::append_number(double v) {
+    char buf[FORMAT_FIELD_MAX];
+    append(buf, size_t(format_plain(buf, v)));
+}
+
+void SnapshotWriter::write_json(const Snapshot &snapshot) {
+    static const char time[] = "{\"time\":";
+    append(time, sizeof(time) - 1);
+    append_number(double(snapshot.time_ns / 1000000) / 1000);
+    for (const auto &field: snapshot.fields) {
+        append(',');
+        append_string(*field.name);
+        append(':');
+        if (std::isnan(field.value)) {
+            append("null", 4);
+        } else {
+            append_number(field.value);
+        }
+    }
+    append("}\n", 2);
+}
+
+void SnapshotWriter::write_csv(const Snapshot &snapshot) {
+    if (columns.empty()) {
+        append("time", 4);
+        for (const auto &field: snapshot.fields) {
+            columns.push_back(*field.name);
+            // device names are the only free text, and commas aren't expected there
+            append(',');
+            append(field.name->data(), field.name->size());
+        }
+        append('\n');
+    }
+    append_number(double(snapshot.time_ns / 1000000) / 1000);
+    // both are sorted by name, so one pass matches them up
+    auto field = snapshot.fields.begin();
+    for (const auto &column: columns) {
+        append(',');
+        while (field != snapshot.fields.end() && *field->name < column) {
+            field++;
+        }
+        if (field != snapshot.fields.end() && *field->name == column && !std::isnan(field->value)) {
+            append_number(field->value);
+        }
+    }
+    append('\n');
+}
+
+bool SnapshotWriter::write(const Snapshot &snapshot) {
+    if (format == CSV) {
+        write_csv(snapshot);
+    } else {
+        write_json(snapshot);
+    }
+    flush();
+    return !failed;
+}
@@ -0,0 +1,99 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SNAPSHOT_H
+#define CCTOP_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// bytes of output held before a write(2); a record that doesn't fit goes out in pieces
+const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+//
+// One update's worth of every metric in history(), as flat name/value
+// pairs: cpu/CPU, memory/used, disk/disk0/read, net/en0/rx...  Per process
+// series are left out.  The names point into history(), so a snapshot is
+// only good until the next update.
+//
+struct Snapshot {
+    struct Field {
+        const std::string *name;
+        float value; // HISTORY_GAP (NaN) where there was no sample
+    };
+
+    uint64_t time_ns{};        // wall clock
+    std::vector<Field> fields; // by name; keeps its capacity from one take() to the next
+
+    void take();
+};
+
+//
+// Writes snapshots to a descriptor, one record per line: NDJSON objects,
+// or CSV with a header row.  Numbers are formatted straight into a fixed
+// buffer that goes out with one write(2) per record, so a long capture
+// costs no allocations and no stdio.
+//
+// CSV columns are those of the first snapshot; metrics that turn up later
+// (a disk plugged in) are left out, and ones that go away are blank.
+//
+class SnapshotWriter {
+public:
+    enum Format {
+        NDJSON,
+        CSV,
+    };
+
+public:
+    SnapshotWriter(int fd, Format format) : fd(fd), format(format) {}
+
+    SnapshotWriter(const SnapshotWriter &) = delete;
+
+    SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+public:
+    // false if the descriptor won't take any more (a closed pipe)
+    bool write(const Snapshot &snapshot);
+
+protected:
+    int fd;
+    Format format;
+    bool failed{false};
+    char buffer[SNAPSHOT_BUFFER_SIZE]{};
+    size_t length{0};
+    std::vector<std::string> columns; // CSV
+
+    void flush();
+
+    void append(const char *s, size_t n);
+
+    void append(char c);
+
+    void append_string(const std::string &s); // quoted, for JSON
+
+    void append_number(double v);
+
+    void write_json(const Snapshot &snapshot);
+
+    void write_csv(const Snapshot &snapshot);
+};
+
+#endif //CCTOP_SNAPSHOT_H
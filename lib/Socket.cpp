@@ -0,0 +1,157 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "Socket.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool socket_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+static bool unix_address(const char *address, sockaddr_un &sun) {
+    if (strlen(address) >= sizeof(sun.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    sun = sockaddr_un{};
+    sun.sun_family = AF_UNIX;
+    strcpy(sun.sun_path, address);
+    return true;
+}
+
+// host and port, for getaddrinfo(); nullptr if it went wrong (errno set)
+static addrinfo *resolve(const char *address, bool passive) {
+    std::string host = "127.0.0.1", port = address;
+    const char *colon = strrchr(address, ':');
+    if (colon) {
+        host.assign(address, colon);
+        port = colon + 1;
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+    }
+    addrinfo hints{}, *found = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = (passive ? AI_PASSIVE : 0) | AI_NUMERICSERV;
+    int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+    if (rc != 0) {
+        errno = rc == EAI_SYSTEM ? errno : EINVAL;
+        return nullptr;
+    }
+    return found;
+}
+
+int socket_listen(const char *address, std::string &path) {
+    int fd = -1;
+    bool named = strchr(address, '/') != nullptr;
+    if (named) {
+        sockaddr_un sun{};
+        if (!unix_address(address, sun)) {
+            return -1;
+        }
+        // one left behind by an earlier run: nothing answers on it.  One that's
+        // still served, or anything else, is left alone and bind() says so.
+        struct stat st{};
+        if (lstat(address, &st) == 0 && S_ISSOCK(st.st_mode)) {
+            int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (probe >= 0) {
+                if (connect(probe, (sockaddr *) &sun, sizeof(sun)) < 0 && errno == ECONNREFUSED) {
+                    unlink(address);
+                }
+                close(probe);
+            }
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (sockaddr *) &sun, sizeof(sun)) < 0) {
+            int e = errno;
+            if (fd >= 0) {
+                close(fd);
+            }
+            errno = e;
+            return -1;
+        }
+    } else {
+        addrinfo *found = resolve(address, true);
+        if (!found) {
+            return -1;
+        }
+        int e = EADDRNOTAVAIL;
+        for (addrinfo *ai = found; ai && fd < 0; ai = ai->ai_next) {
+            fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd < 0) {
+                e = errno;
+                continue;
+            }
+            int on = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+                e = errno;
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(found);
+        if (fd < 0) {
+            errno = e;
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) < 0 || !socket_nonblocking(fd)) {
+        int e = errno;
+        close(fd);
+        if (named) {
+            unlink(address);
+        }
+        errno = e;
+        return -1;
+    }
+    if (named) {
+        path = address;
+    }
+    return fd;
+}
+
+bool socket_address(const char *address, sockaddr_storage &out, socklen_t &length) {
+    out = sockaddr_storage{};
+    if (strchr(address, '/')) {
+        sockaddr_un sun{};
+        if (!unix_address(address, sun)) {
+            return false;
+        }
+        memcpy(&out, &sun, sizeof(sun));
+        length = sizeof(sun);
+        return true;
+    }
+    addrinfo *found = resolve(address, false);
+    if (!found) {
+        return false;
+    }
+    memcpy(&out, found->ai_addr, found->ai_addrlen);
+    length = found->ai_addrlen;
+    freeaddrinfo(found);
+    return true;
+}
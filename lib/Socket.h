@@ -0,0 +1,44 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SOCKET_H
+#define CCTOP_SOCKET_H
+
+#include <string>
+#include <sys/socket.h>
+
+//
+// Addresses as cctop's options take them: "port", "host:port",
+// "[v6 address]:port", or a unix socket path (anything with a /).  A port
+// alone is localhost; say 0.0.0.0 or [::] to be reached from elsewhere.
+//
+
+// make fd non-blocking and close-on-exec
+bool socket_nonblocking(int fd);
+
+// A non-blocking socket listening on address; -1 (with errno) if it can't
+// be listened on.  For a unix socket, one left behind by an earlier run is
+// replaced, one something still listens on fails with EADDRINUSE, and path
+// is set so it can be removed on exit.
+int socket_listen(const char *address, std::string &path);
+
+// where to connect() to reach address; false (with errno) if it isn't one
+bool socket_address(const char *address, sockaddr_storage &out, socklen_t &length);
+
+#endif //CCTOP_SOCKET_H
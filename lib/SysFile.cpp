@@ -0,0 +1,110 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "SysFile.h"
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Most sysfs attributes are a handful of bytes; procfs tables grow the buffer
+// on demand.
+const size_t SYSFILE_INITIAL_SIZE = 256;
+
+SysFile::SysFile(const char *path) {
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+}
+
+SysFile::~SysFile() {
+    if (fd >= 0) {
+        close(fd);
+    }
+    fd = -1;
+    free(buffer);
+    buffer = nullptr;
+}
+
+const char *SysFile::read(size_t *length) {
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (!buffer) {
+        size = SYSFILE_INITIAL_SIZE;
+        buffer = (char *) malloc(size);
+    }
+
+    size_t len = 0;
+    for (;;) {
+        ssize_t n = pread(fd, &buffer[len], size - len - 1, off_t(len));
+        if (n < 0) {
+            return nullptr;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+        if (len == size - 1) {
+            // the file is bigger than our buffer; grow it and keep reading.
+            // The buffer is kept for the next read, so this only happens
+            // while the file is growing.
+            size *= 2;
+            buffer = (char *) realloc(buffer, size);
+        }
+    }
+    buffer[len] = '\0';
+    if (length) {
+        *length = len;
+    }
+    return buffer;
+}
+
+bool SysFile::read_long(int64_t *value) {
+    const char *s = read();
+    if (!s || !*s) {
+        return false;
+    }
+    char *end;
+    long long v = strtoll(s, &end, 10);
+    if (end == s) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+bool SysFile::exists(const char *path) {
+    return access(path, R_OK) == 0;
+}
+
+bool SysFile::read_string(const char *path, char *out, size_t size) {
+    int f = open(path, O_RDONLY | O_CLOEXEC);
+    if (f < 0) {
+        return false;
+    }
+    ssize_t n = ::read(f, out, size - 1);
+    close(f);
+    if (n <= 0) {
+        return false;
+    }
+    out[n] = '\0';
+    if (out[n - 1] == '\n') {
+        out[n - 1] = '\0';
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_SYSFILE_H
+#define CCTOP_SYSFILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// A /sys or /proc file that is opened once and re-read from offset 0 with
+// pread() on every sample.  Unlike Parser, this costs a single syscall per
+// read instead of open/read/close, which adds up when there are several
+// files per core.
+//
+// Files that don't exist (e.g. no cpufreq driver, or we're on MacOS) leave
+// the SysFile closed; ok() returns false and the read methods fail.
+//
+class SysFile {
+public:
+    explicit SysFile(const char *path);
+
+    ~SysFile();
+
+    SysFile(const SysFile &) = delete;
+
+    SysFile &operator=(const SysFile &) = delete;
+
+public:
+    bool ok() const { return fd >= 0; }
+
+    int descriptor() const { return fd; }
+
+    // read the whole file; returns nullptr if the file is not available.
+    // The returned buffer is owned by the SysFile, is nul terminated, and is
+    // valid until the next read().
+    const char *read(size_t *length = nullptr);
+
+    // read the file as a single integer (e.g. scaling_cur_freq)
+    bool read_long(int64_t *value);
+
+public:
+    // true if path exists and is readable
+    static bool exists(const char *path);
+
+    // read a short file (e.g. hwmon name or label) once into out, stripping
+    // the trailing newline.  Returns false if the file can't be read.
+    static bool read_string(const char *path, char *out, size_t size);
+
+protected:
+    int fd{-1};
+    char *buffer{nullptr};
+    size_t size{0};
+};
+
+#endif //CCTOP_SYSFILE_H
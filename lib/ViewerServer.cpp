@@ -0,0 +1,209 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#include "ViewerServer.h"
+#include "EventLoop.h"
+#include "Socket.h"
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // MacOS: SO_NOSIGPIPE is set on the socket instead
+#endif
+
+// frames handed to one sendmsg()
+static const int VIEWER_SEND_FRAMES = 16;
+
+ViewerServer::~ViewerServer() {
+    if (fd >= 0) {
+        close(fd);
+        if (!path.empty()) {
+            unlink(path.c_str());
+        }
+    }
+}
+
+bool ViewerServer::listen(const char *address) {
+    fd = socket_listen(address, path);
+    if (fd < 0) {
+        return false;
+    }
+    if (!path.empty()) {
+        // anyone logged in can run top; they can watch this instead
+        chmod(path.c_str(), 0666);
+    }
+    eventLoop.watch(fd, EVENT_READ, [this] { accept_clients(); });
+    return true;
+}
+
+RecordingWriter &ViewerServer::begin(const Snapshot &snapshot) {
+    if (restart) {
+        writer.restart();
+        restart = false;
+    }
+    writer.begin(snapshot);
+    return writer;
+}
+
+void ViewerServer::end() {
+    // a writer that isn't writing to a file can't fail
+    writer.end();
+    if (clients.empty()) {
+        return;
+    }
+    auto frame = std::make_shared<std::string>();
+    writer.frame(*frame);
+    bool key = writer.keyframe();
+    for (auto &it: clients) {
+        Client &c = it.second;
+        if (c.synced && c.queue.size() >= VIEWER_MAX_BACKLOG) {
+            // What's been sent so far is a whole stream up to the front
+            // frame; the rest goes, and it starts again at a keyframe.
+            c.queue.resize(1);
+            c.synced = false;
+            restart = true;
+        }
+        if (!c.synced) {
+            if (!key) {
+                continue;
+            }
+            c.synced = true;
+        }
+        c.queue.push_back(frame);
+    }
+    // close_client() can't run inside the loop above
+    for (auto it = clients.begin(); it != clients.end();) {
+        int client = it->first;
+        bool writing = it->second.writing;
+        ++it;
+        if (!writing) {
+            send_queue(client);
+        }
+    }
+}
+
+void ViewerServer::accept_clients() {
+    static const Frame magic = std::make_shared<const std::string>(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    for (;;) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            // EAGAIN: that's all of them
+            return;
+        }
+        if (clients.size() >= VIEWER_MAX_CLIENTS || !socket_nonblocking(client)) {
+            close(client);
+            continue;
+        }
+        int on = 1;
+#ifdef SO_NOSIGPIPE
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        // a frame is one write; send it now rather than wait for the last one's ack (fails on a unix socket)
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        clients[client].queue.push_back(magic);
+        // so it has something to start from on the next update
+        restart = true;
+        eventLoop.watch(client, EVENT_READ, [this, client] { service(client); });
+        send_queue(client);
+    }
+}
+
+void ViewerServer::service(int client) {
+    char buf[512];
+    for (;;) {
+        ssize_t n = recv(client, buf, sizeof(buf), 0);
+        if (n > 0 || (n < 0 && errno == EINTR)) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            // gone
+            close_client(client);
+            return;
+        }
+        break;
+    }
+    if (clients[client].writing) {
+        send_queue(client);
+    }
+}
+
+void ViewerServer::send_queue(int client) {
+    Client &c = clients[client];
+    while (!c.queue.empty()) {
+        iovec iov[VIEWER_SEND_FRAMES];
+        int n = 0;
+        size_t offset = c.sent, total = 0;
+        for (const auto &frame: c.queue) {
+            if (n == VIEWER_SEND_FRAMES) {
+                break;
+            }
+            iov[n++] = {(void *) (frame->data() + offset), frame->size() - offset};
+            total += frame->size() - offset;
+            offset = 0;
+        }
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        ssize_t sent = sendmsg(client, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            close_client(client);
+            return;
+        }
+        for (auto left = size_t(sent); left > 0;) {
+            size_t rest = c.queue.front()->size() - c.sent;
+            if (left < rest) {
+                c.sent += left;
+                break;
+            }
+            left -= rest;
+            c.queue.pop_front();
+            c.sent = 0;
+        }
+        if (size_t(sent) < total) {
+            // the socket buffer is full
+            break;
+        }
+    }
+    // the rest when there's room
+    bool writing = !c.queue.empty();
+    if (writing != c.writing) {
+        c.writing = writing;
+        eventLoop.watch(client, EVENT_READ | (writing ? EVENT_WRITE : 0), [this, client] { service(client); });
+    }
+}
+
+void ViewerServer::close_client(int client) {
+    eventLoop.unwatch(client);
+    close(client);
+    clients.erase(client);
+}
+
+ViewerServer viewerServer;
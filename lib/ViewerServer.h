@@ -0,0 +1,98 @@
+/*
+ * cctop for MacOS and Linux
+ *
+ * Programmed by Mike Schwartz <mike@moduscreate.com>
+ *
+ * Command line tool that refreshes the terminal/console window each second,
+ * showing uptime, load average, CPU usage/stats, Memory/Swap usage, Disk
+ * Activity (per drive/device), Virtual Memory activity (paging/swapping), and
+ * Network traffic (per interface).
+ *
+ * Run this on a busy macos and you can diagnose if:
+ * 1) System is CPU bound
+ * 2) System is RAM bound
+ * 3) System is Disk bound
+ * 4) System is Paging/Swapping heavily
+ * 5) System is Network bound
+ *
+ * To exit, hit ^C.
+ */
+#ifndef CCTOP_VIEWERSERVER_H
+#define CCTOP_VIEWERSERVER_H
+
+#include "Recording.h"
+#include "Snapshot.h"
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// viewers served at once; more are turned away
+const size_t VIEWER_MAX_CLIENTS = 64;
+
+// frames a viewer can fall behind before it's made to start over at a keyframe
+const size_t VIEWER_MAX_BACKLOG = 32;
+
+//
+// -d: the daemon (or, on a TCP port, agent) side of cctop -c.  Every
+// update is coded once, as a recording frame (see Recording.h), and the
+// same buffer is queued for every viewer connected, so the sampling is
+// done once however many are watching.  A viewer gets the recording magic and
+// then frames; its first is a keyframe, forced when it connects, and the
+// rest are deltas.  Sockets are non-blocking: one that can't keep up
+// loses what it hasn't been sent and picks up again at the next keyframe
+// rather than holding up the others or growing without bound.
+//
+class ViewerServer {
+public:
+    ViewerServer() = default;
+
+    ViewerServer(const ViewerServer &) = delete;
+
+    ViewerServer &operator=(const ViewerServer &) = delete;
+
+    ~ViewerServer();
+
+public:
+    // a unix socket path or [host:]port (see Socket.h); false (with errno) if it can't be listened on
+    bool listen(const char *address);
+
+    bool listening() const { return fd >= 0; }
+
+    size_t viewers() const { return clients.size(); }
+
+    // one frame for every viewer: begin(), the processes into what it returns, end()
+    RecordingWriter &begin(const Snapshot &snapshot);
+
+    void end();
+
+protected:
+    using Frame = std::shared_ptr<const std::string>;
+
+    struct Client {
+        std::deque<Frame> queue; // the front one sent up to sent
+        size_t sent{0};
+        bool synced{false};      // has had a keyframe
+        bool writing{false};     // waiting for room in the socket
+    };
+
+    int fd{-1};
+    std::string path; // unix socket, removed on exit
+    RecordingWriter writer;
+    bool restart{false}; // someone needs a keyframe
+    std::unordered_map<int, Client> clients;
+
+    void accept_clients();
+
+    // read (and ignore) what the viewer sends, then send what's queued
+    void service(int client);
+
+    void send_queue(int client);
+
+    void close_client(int client);
+};
+
+extern ViewerServer viewerServer;
+
+#endif //CCTOP_VIEWERSERVER_H
@@ -18,6 +18,9 @@
  * To exit, hit ^C.
  */
 #include "../cctop.h"
+#include <algorithm>
+#include <cmath>
+#include <mach/mach.h>
 #include <mach/mach_host.h>
 #include <unistd.h>
 
@@ -45,7 +48,6 @@ struct dots {
 };
 
 static void renderColor(int ndx) {
-#ifdef USE_NCURSES
     switch (ndx) {
         case -1:
 //            debug.log("x ");
@@ -92,68 +94,76 @@ static void renderColor(int ndx) {
             console.mode_clear();
             break;
     }
-#else
-    switch (ndx) {
-        case 0:
-            console.fg_yellow();
-            break;
-        case 1:
-            console.fg_cyan();
-            break;
-        case 2:
-            console.fg_cyan();
-            break;
-        case 3:
-            console.mode_bold();
-            console.fg_blue();
-            break;
-        case 4:
-            console.fg_magenta();
-            break;
-        case 5:
-            console.fg_magenta();
-            console.mode_bold();
-            break;
-        case 6:
-            console.fg_red();
-            break;
-        case 7:
-            console.fg_red();
-            console.mode_bold();
-            break;
-        default:
-            break;
-    }
-#endif
 }
 
 static void renderDot(int level) {
-#ifdef USE_NCURSES
     renderColor(level);
     if (level >= 0 && level <= 7) {
-        console.wprintf(L"%lc", dots[level].ch);
+        console.write(wchar_t(dots[level].ch));
     } else {
         // leve = -1 (uninitialized)
         console.print(" ");
     }
     console.mode_clear();
-#else
-    if (ndx >= 0 && ndx <= 7) {
-        renderColor(ndx);
-//        console.fg_rgb(dots[ndx].r, dots[ndx].g, dots[ndx].b);
-        console.wprint(L"%lc", dots[ndx].ch);
-//        console.fg_rgb(255, 255, 255);
-        console.mode_clear();
-    } else {
-        console.print(" ");
+}
+
+// Width of a CPU line without the optional columns, and of the optional ones.
+const int CPU_LINE_WIDTH = 94, SENSORS_WIDTH = 12, SCHED_WIDTH = 26;
+
+// Frequency/throttle columns are only shown if the platform exposes them and
+// there's room for them.
+static bool show_sensors() {
+    return !processor.loaded && (sensors.has_frequency || sensors.has_throttle) && console.width >= CPU_LINE_WIDTH + SENSORS_WIDTH;
+}
+
+// Same for the run queue columns and sparkline.
+static bool show_sched() {
+    int needed = CPU_LINE_WIDTH + SCHED_WIDTH + (show_sensors() ? SENSORS_WIDTH : 0);
+    return !processor.loaded && schedstat.ok() && console.width >= needed;
+}
+
+static void printSensors(int id) {
+    char mhz[16] = "-", throttles[16] = "-";
+    int64_t value = sensors.frequency(id);
+    if (value >= 0) {
+        sprintf(mhz, "%lld", (long long) value);
+    }
+    value = sensors.throttles(id);
+    if (value >= 0) {
+        sprintf(throttles, "%lld", (long long) value);
     }
-#endif
+    console.print("%6s ", mhz);
+    if (value > 0) {
+        console.fg_red();
+        console.mode_bold();
+    }
+    console.print("%4s ", throttles);
+    console.mode_clear();
 }
 
-CPUCore::CPUCore() {
-    for (int &i: history) {
-        i = -1;
+static void printSched(int id) {
+    char wait[16] = "-", slices[16] = "-";
+    double ms = schedstat.wait_ms(id);
+    if (ms >= 0) {
+        sprintf(wait, "%.1f", ms);
+    }
+    int64_t n = schedstat.timeslices(id);
+    if (n >= 0) {
+        sprintf(slices, "%lld", (long long) n);
     }
+    console.print("%7s %6s ", wait, slices);
+}
+
+// 0-7 for a CPU's % busy, -1 for no data
+static int use_level(double use) {
+    if (!(use >= 0)) {
+        return -1;
+    }
+    return use < 87.5 ? int(use / 12.5) : 7;
+}
+
+static std::string series_name(const char *name) {
+    return std::string("cpu/") + name;
 }
 
 void CPUCore::diff(CPUCore *newer, CPUCore *older) {
@@ -163,50 +173,39 @@ void CPUCore::diff(CPUCore *newer, CPUCore *older) {
     this->idle = newer->idle - older->idle;
 }
 
-void CPUCore::addHistory(int h) {
-    for (int i=0; i<CPU_HISTORY_SIZE-1; i++) {
-        history[i] = history[i+1];
-    }
-    history[CPU_HISTORY_SIZE-1] = h;
-}
-
-void CPUCore::print() {
+void CPUCore::print(const char *name, int id, bool alert) {
     double total = 100.,
-            _user = double(this->user),
-            _system = double(this->system),
-            _nice = double(this->nice),
-            _use = _user + _system + _nice,
+            _user = percent(this->user),
+            _system = percent(this->system),
+            _nice = percent(this->nice),
+            _use = use(),
 //            _idle = this->idle > 100 ? 100. : double(this->idle),
     _idle = total - _use;
 
-    int ndx = -1;
-    if (_use < 12.5) {
-        ndx = 0;
-    } else if (_use < 25.0) {
-        ndx = 1;
-    } else if (_use < 37.5) {
-        ndx = 2;
-    } else if (_use < 50.0) {
-        ndx = 3;
-    } else if (_use < 62.5) {
-        ndx = 4;
-    } else if (_use < 75.0) {
-        ndx = 5;
-    } else if (_use < 87.5) {
-        ndx = 6;
-    } else {
-        ndx = 7;
-    }
-
-    addHistory(ndx);
+    int ndx = use_level(_use);
 
-    console.wprintf(L"  %-6s %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%% ",
-                    this->name,
-                    _use,
-                    _user,
-                    _system,
-                    _nice,
-                    _idle);
+    console.write("  ");
+    if (alert) {
+        // the gauge and dots below reset the modes, so the row is marked up to them
+        console.mode_inverse();
+        console.mode_bold();
+    }
+    console.write(Text(name, -6, 0));
+    if (alert) {
+        console.mode_inverse(false);
+    }
+    console.write(' ', Percent(_use, 6, 1),
+                  ' ', Percent(_user, 6, 1),
+                  ' ', Percent(_system, 6, 1),
+                  ' ', Percent(_nice, 6, 1),
+                  ' ', Percent(_idle, 6, 1), ' ');
+    console.mode_clear();
+    if (show_sensors()) {
+        printSensors(id);
+    }
+    if (show_sched()) {
+        printSched(id);
+    }
 
     renderDot(ndx);
 //    console.mode_clear();
@@ -226,7 +225,7 @@ void CPUCore::print() {
 
     renderColor(ndx);
     for (int cnt = 0; cnt < int(use); cnt++) {
-        console.wprintf(L"%lc", 0x25a0);
+        console.write(wchar_t(0x25a0));
     }
 
     for (int cnt = 0; cnt < left; cnt++) {
@@ -238,21 +237,31 @@ void CPUCore::print() {
     console.print("] ");
     console.mode_clear();
 
-//    debug.log("\n");
-    for (int i : history) {
-//        debug.log("%d", i);
-        renderColor(i);
-        renderDot(i);
-        console.mode_clear();
+    // oldest first, blank until there's a full window
+    const Series *series = history().find(series_name(name));
+    uint32_t n = series ? std::min(series->size(), uint32_t(CPU_HISTORY_SIZE)) : 0;
+    const float *samples = series ? series->window(n) : nullptr;
+    for (int i = 0; i < CPU_HISTORY_SIZE; i++) {
+        int level = i < CPU_HISTORY_SIZE - int(n) ? -1 : use_level(samples[i - (CPU_HISTORY_SIZE - n)]);
+        renderDot(level);
+    }
+    const Series *wait = schedstat.wait_history(id);
+    if (show_sched() && wait) {
+        console.print(" ");
+        n = std::min(wait->size(), uint32_t(SCHED_HISTORY_SIZE));
+        samples = wait->window(n);
+        for (int i = 0; i < SCHED_HISTORY_SIZE; i++) {
+            renderDot(i < SCHED_HISTORY_SIZE - int(n) ? -1 : SchedStat::wait_level(samples[i - (SCHED_HISTORY_SIZE - n)]));
+        }
     }
 //    debug.log("\n");
     console.newline();
 }
 
 CPU::CPU() {
-    num_cores = this->read(this->current);
-    copy(this->last, this->current);
-    copy(this->delta, this->current);
+    cores.begin();
+    num_cores = this->read();
+    cores.end();
     this->update();
 }
 
@@ -282,94 +291,160 @@ static void sample(struct cpusample *sample) {
 }
 
 //                                                      ⢠⣿⣿                              │CPU ■■■■■■■■■■  26% ⡀⡀⡀⡀⡀   0°C│ │
-uint16_t CPU::read(std::map<std::string, CPUCore *> &m) {
+uint16_t CPU::read() {
     cpusample sam;
     sample(&sam);
     processor_cpu_load_info_t cpuLoad;
     mach_msg_type_number_t processorMsgCount;
     natural_t processorCount;
 
-    total_ticks = 0;
     /* kern_return_t err = */ host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &processorCount,
                                                   (processor_info_array_t *) &cpuLoad, &processorMsgCount);
-    CPUCore *total = m["CPU"];
-    if (!total) {
-        total = m["CPU"] = new CPUCore;
-        total->name = strdup("CPU");
-    }
+    CPUCore *total = cores.sample("CPU");
     total->system = total->user = total->nice = total->idle = 0;
     for (natural_t i = 0; i < processorCount; i++) {
         unsigned int *cpu_ticks = &cpuLoad[i].cpu_ticks[0];
         char name[3 + 3 + 1];
         sprintf(name, "CPU%d", i);
-        CPUCore *cpu = m[name];
-        if (!cpu) {
-            cpu = m[name] = new CPUCore;
-            cpu->name = strdup(name);
-        }
+        CPUCore *cpu = cores.sample(name);
         cpu->system = cpu_ticks[CPU_STATE_SYSTEM];
         cpu->user = cpu_ticks[CPU_STATE_USER];
         cpu->nice = cpu_ticks[CPU_STATE_NICE];
         cpu->idle = cpu_ticks[CPU_STATE_IDLE];
-        total_ticks += cpu->system + cpu->user + cpu->idle + cpu->nice;
-
         total->system += cpu->system;
         total->user += cpu->user;
         total->nice += cpu->nice;
         total->idle += cpu->idle;
     }
+    // host_processor_info() hands back a fresh vm allocation every call
+    vm_deallocate(mach_task_self(), (vm_address_t) cpuLoad, processorMsgCount * sizeof(integer_t));
     return (uint16_t) processorCount;
 }
 
-void CPU::copy(std::map<std::string, CPUCore *> &dst,
-               std::map<std::string, CPUCore *> &src) {
-    for (const auto &kv: src) {
-        CPUCore *o = (CPUCore *) kv.second;
-        const char *name = o->name;
+// % busy, and the user and system parts of it (nice is the rest); gaps for an offline core
+static void append(const char *name, const Device<CPUCore> *core) {
+    std::string series = series_name(name);
+    const CPUCore *d = core && core->present ? &core->delta : nullptr;
+    history().series(series)->append(d ? float(d->use()) : HISTORY_GAP);
+    history().series(series + "/user")->append(d ? float(d->percent(d->user)) : HISTORY_GAP);
+    history().series(series + "/system")->append(d ? float(d->percent(d->system)) : HISTORY_GAP);
+}
 
-        CPUCore *cpu = dst[name];
-        if (!cpu) {
-            cpu = dst[name] = new CPUCore;
-            cpu->name = strdup(name);
+void CPU::update() {
+    cores.begin();
+    num_cores = this->read();
+    cores.end();
+    append("CPU", cores.find("CPU"));
+    for (int i = 0; i < num_cores; i++) {
+        char name[32];
+        sprintf(name, "CPU%d", i);
+        append(name, cores.find(name));
+    }
+}
+
+// a recorded percent as ticks out of 100000, which print() shows as it was
+static uint64_t ticks(float percent) {
+    return std::isnan(percent) ? 0 : uint64_t(std::min(std::max(percent, 0.f), 100.f) * 1000);
+}
+
+void CPU::load(const RecordingReader &reader) {
+    struct Recorded {
+        float use{HISTORY_GAP}, user{HISTORY_GAP}, system{HISTORY_GAP};
+    };
+    std::map<std::string, Recorded> recorded;
+    for (const auto &v: reader.values) {
+        const std::string &name = reader.series_names[v.first];
+        if (!name.compare(0, 4, "cpu/") && name.find('/', 4) == std::string::npos) {
+            recorded[name.substr(4)].use = v.second;
+        }
+    }
+    reader.each_device("cpu", [&](const std::string &name, const char *measurement, float value) {
+        auto it = recorded.find(name);
+        if (it == recorded.end()) {
+            return;
+        }
+        if (!strcmp(measurement, "user")) {
+            it->second.user = value;
+        } else if (!strcmp(measurement, "system")) {
+            it->second.system = value;
+        }
+    });
+
+    loaded = true;
+    num_cores = 0;
+    cores.begin();
+    // print() always has a total, if only an idle one
+    *cores.sample("CPU") = CPUCore{0, 0, 0, 100000};
+    for (const auto &it: recorded) {
+        const Recorded &r = it.second;
+        if (std::isnan(r.use)) {
+            // offline
+            continue;
+        }
+        CPUCore *core = cores.sample(it.first);
+        uint64_t use = ticks(r.use);
+        // a recording from before the split is all user
+        core->user = std::isnan(r.user) ? use : std::min(ticks(r.user), use);
+        core->system = std::min(ticks(r.system), use - core->user);
+        core->nice = use - core->user - core->system;
+        core->idle = 100000 - use;
+        if (it.first.size() > 3) {
+            num_cores = std::max(num_cores, atoi(it.first.c_str() + 3) + 1);
         }
-        cpu->user = o->user;
-        cpu->system = o->system;
-        cpu->idle = o->idle;
-        cpu->nice = o->nice;
     }
+    cores.end();
+    cores.each([](Device<CPUCore> &d) { d.delta = d.current; });
 }
 
-void CPU::update() {
-    this->copy(this->last, this->current);
-    this->read(this->current);
-    for (const auto &kv: this->delta) {
-        CPUCore *cpu = (CPUCore *) kv.second;
-        cpu->diff(this->current[cpu->name], this->last[cpu->name]);
+uint16_t CPU::rows() {
+    uint16_t count = 2 + (loaded ? 0 : sensors.rows());
+    if (!options.condenseCPU) {
+        for (int i = 0; i < num_cores; i++) {
+            char name[32];
+            sprintf(name, "CPU%d", i);
+            Device<CPUCore> *core = cores.find(name);
+            if (core && core->present) {
+                count++;
+            }
+        }
     }
-    CPUCore *cpu = this->delta["CPU"];
-    cpu->user /= this->num_cores;
-    cpu->system /= this->num_cores;
-    cpu->nice /= this->num_cores;
-    cpu->idle /= this->num_cores;
+    return count;
 }
 
 uint16_t CPU::print(bool newline) {
     uint16_t count = 0;
-    CPUCore *cpu;
 
-    console.inverseln("  %-6s %7s %7s %7s %7s %7s    %-5.5s                 %s", "[C]PUS", "Use", "User",
-                      "System", "Nice", "Idle", "Gauge", "History");
+    char header[256];
+    int n = sprintf(header, "  %-6s %7s %7s %7s %7s %7s", "[C]PUS", "Use", "User", "System", "Nice", "Idle");
+    if (show_sensors()) {
+        n += sprintf(&header[n], " %6s %4s", "MHz", "Thr");
+    }
+    if (show_sched()) {
+        n += sprintf(&header[n], " %7s %6s", "RQ ms/s", "Slc/s");
+    }
+    n += sprintf(&header[n], "    %-5.5s                 %-20s", "Gauge", "History");
+    if (show_sched()) {
+        sprintf(&header[n], " %s", "RQ Wait");
+    }
+    console.inverseln("%s", header);
     count++;
 
-    cpu = this->delta["CPU"];
-    cpu->print();
+    // any core over its limit marks the total
+    cores.find("CPU")->delta.print("CPU", -1, alerts.active() && alerts.firing("cpu/"));
     count++;
+    if (!loaded) {
+        count += sensors.print();
+    }
     if (!options.condenseCPU) {
         for (int i = 0; i < num_cores; i++) {
             char name[32];
             sprintf(name, "CPU%d", i);
-            cpu = this->delta[name];
-            cpu->print();
+            Device<CPUCore> *core = cores.find(name);
+            if (!core || !core->present) {
+                // offline
+                continue;
+            }
+            core->delta.print(name, i);
             count++;
         }
     }
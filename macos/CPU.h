@@ -21,44 +21,55 @@
 #define C_CPU_H
 
 #include "../cctop.h"
+#include "../lib/DeviceTable.h"
+#include "../lib/History.h"
 #include <map>
 #include <string>
 
+// samples of history shown per CPU
 const int CPU_HISTORY_SIZE = 20;
 
 struct CPUCore {
-    CPUCore();
-
-    int id{};
-    const char *name{};
     uint64_t user{}, nice{}, system{}, idle{};
-    int history[CPU_HISTORY_SIZE]{};
 
     void diff(CPUCore *newer, CPUCore *older);
 
-    void print();
-    void addHistory(int h);
+    // % of the ticks in a delta, so it doesn't matter how long the interval
+    // was or how many cores the total is over
+    double percent(uint64_t ticks) const {
+        uint64_t total = user + nice + system + idle;
+        return total ? 100. * double(ticks) / double(total) : 0;
+    }
+
+    // % busy, for a delta
+    double use() const { return percent(user + system + nice); }
+
+    // id is the core number, -1 for the total; alert marks the row
+    void print(const char *name, int id, bool alert = false);
 };
 
 class CPU {
 public:
-    std::map<std::string, CPUCore *> last, current, delta;
-    uint64_t total_ticks{};
+    DeviceTable<CPUCore> cores;  // CPU0..CPUn, and CPU for the total
     int num_cores;
+    bool loaded{false};          // showing load()'s frames, so no sensors or run queues
 
 public:
     CPU();
 
 public:
     // returns # of processors
-    uint16_t read(std::map<std::string, CPUCore *> &m);
-
-    static void copy(std::map<std::string, CPUCore *> &dst,
-              std::map<std::string, CPUCore *> &src);
+    uint16_t read();
 
     void update();
 
+    // rows print() takes, fewer with options.condenseCPU
+    uint16_t rows();
+
     uint16_t print(bool newline);
+
+    // replay: show the reader's last frame instead of what update() read
+    void load(const RecordingReader &reader);
 };
 
 extern CPU processor;
@@ -24,6 +24,7 @@
  * See copyright info in iostat.txt.
  */
 #include "../cctop.h"
+#include <cmath>
 
 #include <CoreFoundation/CoreFoundation.h>
 #include <IOKit/IOBSD.h>
@@ -229,33 +230,12 @@ Disk::Disk() {
     rls = IONotificationPortGetRunLoopSource(notifyPort);
     CFRunLoopAddSource(CFRunLoopGetCurrent(), rls, kCFRunLoopDefaultMode);
     record_all_devices();
-    this->read(this->current);
-    this->copy(this->last, this->current);
-    this->copy(this->delta, this->current);
+    disks.begin();
+    this->read();
+    disks.end();
 }
 
-void Disk::copy(std::map<std::string, DiskStats *> &dst,
-                std::map<std::string, DiskStats *> &src) {
-    for (const auto &kv: src) {
-        DiskStats *o = (DiskStats *) kv.second;
-        const char *name = o->name;
-
-        DiskStats *stats = dst[name];
-        if (!stats) {
-            stats = dst[name] = new DiskStats;
-            stats->name = strdup(name);
-        }
-        stats->driver = o->driver;
-        stats->blocksize = o->blocksize;
-        stats->total_bytes = o->total_bytes;
-        stats->total_read_bytes = o->total_read_bytes;
-        stats->total_written_bytes = o->total_written_bytes;
-        stats->total_transfers = o->total_transfers;
-        stats->total_time = o->total_time;
-    }
-}
-
-uint16_t Disk::read(std::map<std::string, DiskStats *> &m) {
+uint16_t Disk::read() {
     CFNumberRef number;
     CFDictionaryRef properties;
     CFDictionaryRef statistics;
@@ -343,11 +323,8 @@ uint16_t Disk::read(std::map<std::string, DiskStats *> &m) {
         }
         CFRelease(properties);
 
-        DiskStats *stat = m[drivestat[i].name];
-        if (!stat) {
-            stat = m[drivestat[i].name] = new DiskStats;
-            stat->name = strdup(drivestat[i].name);
-        }
+        DiskStats *stat = disks.sample(drivestat[i].name);
+        stat->driver = drivestat[i].driver;
         stat->blocksize = drivestat[i].blocksize;
         stat->total_bytes = total_bytes;
         stat->total_read_bytes = total_read_bytes;
@@ -359,32 +336,94 @@ uint16_t Disk::read(std::map<std::string, DiskStats *> &m) {
 }
 
 uint16_t Disk::update() {
-    this->copy(this->last, this->current);
-    this->read(this->current);
+    disks.begin();
+    this->read();
+    disks.end();
+    uint64_t read = 0, written = 0, transfers = 0;
+    disks.each([&](Device<DiskStats> &d) {
+        history().series("disk/" + d.name + "/read")->append(float(per_second(d.delta.total_read_bytes)));
+        history().series("disk/" + d.name + "/write")->append(float(per_second(d.delta.total_written_bytes)));
+        history().series("disk/" + d.name + "/ops")->append(float(per_second(d.delta.total_transfers)));
+        read += d.delta.total_read_bytes;
+        written += d.delta.total_written_bytes;
+        transfers += d.delta.total_transfers;
+    });
+    history().series("disk/read")->append(float(per_second(read)));
+    history().series("disk/write")->append(float(per_second(written)));
+    history().series("disk/ops")->append(float(per_second(transfers)));
+    return num_devices;
+}
 
-    for (const auto &kv: this->delta) {
-        DiskStats *stats = (DiskStats *) kv.second;
-        stats->diff(this->current[stats->name], this->last[stats->name]);
+void Disk::load(const RecordingReader &reader) {
+    std::map<std::string, DiskStats> recorded;
+    reader.each_device("disk", [&](const std::string &name, const char *measurement, float value) {
+        DiskStats &stats = recorded[name];
+        uint64_t rate = std::isnan(value) ? 0 : uint64_t(value);
+        if (!strcmp(measurement, "read")) {
+            stats.total_read_bytes = rate;
+        } else if (!strcmp(measurement, "write")) {
+            stats.total_written_bytes = rate;
+        } else if (!strcmp(measurement, "ops")) {
+            stats.total_transfers = rate;
+        }
+    });
+    loaded = true;
+    disks.begin();
+    for (auto &it: recorded) {
+        it.second.total_bytes = it.second.total_read_bytes + it.second.total_written_bytes;
+        *disks.sample(it.first) = it.second;
     }
-    return num_devices;
+    disks.end();
+    // the recorded figures are already per second
+    disks.interval.unit();
+    disks.each([](Device<DiskStats> &d) { d.delta = d.current; });
+}
+
+DiskStats *Disk::find(const char *name) {
+    Device<DiskStats> *d = disks.find(name);
+    return d && d->present ? &d->delta : nullptr;
+}
+
+uint16_t Disk::rows() {
+    uint16_t count = 1;
+    if (!options.condenseDisk) {
+        disks.each([&](Device<DiskStats> &) { count++; });
+    }
+    return count;
 }
 
 uint16_t Disk::print(bool newline) {
     uint16_t count = 0;
 
     console.inverseln("  %-16s %13s %13s %13s %13s %13s", "[D]ISK ACTIVITY",
-                      "Block Size", "Total Bytes", "Read Bytes", "Write Bytes",
-                      "Transfers");
+                      "Block Size", "Total (B/s)", "Read (B/s)", "Write (B/s)",
+                      "Transfers/s");
     count++;
     if (!options.condenseDisk) {
-        for (const auto &kv: this->delta) {
-            DiskStats *stats = (DiskStats *) kv.second;
-            console.println("  %-16s %'13ld %'13ld %'13ld %'13ld %'13ld", stats->name,
-                            stats->blocksize, stats->total_bytes,
-                            stats->total_read_bytes, stats->total_written_bytes,
-                            stats->total_transfers);
+        disks.each([&](Device<DiskStats> &d) {
+            DiskStats *stats = &d.delta;
+            bool alert = alerts.active() && alerts.firing("disk/" + d.name + "/");
+            console.write("  ");
+            if (alert) {
+                console.mode_inverse();
+                console.mode_bold();
+            }
+            console.write(Text(d.name, -16, 0));
+            if (alert) {
+                console.mode_inverse(false);
+            }
+            if (loaded) {
+                console.write(' ', Text("-", 13));
+            } else {
+                console.write(' ', Grouped(d.current.blocksize, 13));
+            }
+            console.writeln(' ', Grouped(int64_t(per_second(stats->total_bytes)), 13),
+                            ' ', Grouped(int64_t(per_second(stats->total_read_bytes)), 13),
+                            ' ', Grouped(int64_t(per_second(stats->total_written_bytes)), 13),
+                            ' ', Grouped(int64_t(per_second(stats->total_transfers)), 13));
+            console.mode_clear();
             count++;
-        }
+        });
     }
     if (newline) {
         console.newline();
@@ -27,6 +27,7 @@
 #define SYSTAT_DISK_H
 
 #include "../cctop.h"
+#include "../lib/DeviceTable.h"
 
 #define IOKIT 1 /* to get io_name_t in device_types.h */
 
@@ -37,7 +38,6 @@
 
 struct DiskStats {
   io_registry_entry_t driver;
-  char *name;
   u_int64_t blocksize;
   u_int64_t total_bytes;
   u_int64_t total_read_bytes;
@@ -50,10 +50,11 @@ struct DiskStats {
 class Disk {
 public:
   uint16_t num_devices;
-  uint8_t pad[6];
+  bool loaded{false}; // showing load()'s frames, which have no block sizes
+  uint8_t pad[5];
 
 protected:
-  std::map<std::string, DiskStats *> last, current, delta;
+  DeviceTable<DiskStats> disks;
 
 public:
   int record_device(io_registry_entry_t drive);
@@ -65,10 +66,7 @@ public:
   int record_all_devices();
 
 protected:
-  uint16_t read(std::map<std::string, DiskStats *> &m);
-
-  static void copy(std::map<std::string, DiskStats *> &dst,
-            std::map<std::string, DiskStats *> &src);
+  uint16_t read();
 
 public:
   Disk();
@@ -76,7 +74,19 @@ public:
 public:
   uint16_t update();
 
+  // header plus a row per disk, unless condensed
+  uint16_t rows();
+
   uint16_t print(bool newline);
+
+  // activity during the last interval for a whole disk, e.g. disk3 (or nullptr)
+  DiskStats *find(const char *name);
+
+  // a delta from find() per second
+  double per_second(uint64_t delta) const { return disks.interval.per_second(double(delta)); }
+
+  // replay: show the reader's last frame instead of what update() read
+  void load(const RecordingReader &reader);
 };
 
 extern Disk disk;
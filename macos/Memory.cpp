@@ -25,6 +25,7 @@
  */
 
 #include "../cctop.h"
+#include <cmath>
 #include <mach/mach.h>
 #include <unistd.h>
 
@@ -32,6 +33,7 @@ Memory::Memory() {
     this->page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
 
     this->read(&this->last);
+    interval.stamp();
     this->update();
 }
 
@@ -78,6 +80,7 @@ void Memory::update() {
             *last = &this->last,
             *delta = &this->delta;
 
+    interval.stamp();
     this->read(&this->current);
 
     delta->free_count = current->free_count - last->free_count;
@@ -93,6 +96,66 @@ void Memory::update() {
     delta->swap_size = current->swap_size - last->swap_size;
     delta->swap_used = current->swap_used - last->swap_used;
     delta->swap_free = current->swap_free - last->swap_free;
+    *last = *current;
+
+    history().series("memory/total")->append(float(current->memory_size));
+    history().series("memory/used")->append(float(current->memory_used));
+    history().series("memory/free")->append(float(current->memory_free));
+    history().series("memory/wired")->append(float(current->wire_count * page_size));
+    history().series("memory/cached")->append(
+            float(page_size * (current->external_page_count + current->purgeable_count)));
+    history().series("swap/total")->append(float(current->swap_size));
+    history().series("swap/used")->append(float(current->swap_used));
+    history().series("swap/free")->append(float(current->swap_free));
+    history().series("vm/pageins")->append(float(interval.per_second(double(delta->pageins))));
+    history().series("vm/pageouts")->append(float(interval.per_second(double(delta->pageouts))));
+    history().series("vm/swapins")->append(float(interval.per_second(double(delta->swapins))));
+    history().series("vm/swapouts")->append(float(interval.per_second(double(delta->swapouts))));
+}
+
+void Memory::load(const RecordingReader &reader) {
+    loaded = true;
+    interval.unit();
+    current = delta = MemoryStats{};
+    for (const auto &v: reader.values) {
+        const std::string &name = reader.series_names[v.first];
+        uint64_t value = std::isnan(v.second) ? 0 : uint64_t(v.second);
+        // print() shows the wired and cached figures as pages
+        if (name == "memory/total") {
+            current.memory_size = value;
+        } else if (name == "memory/used") {
+            current.memory_used = value;
+        } else if (name == "memory/free") {
+            current.memory_free = value;
+        } else if (name == "memory/wired") {
+            current.wire_count = value / page_size;
+        } else if (name == "memory/cached") {
+            current.external_page_count = value / page_size;
+        } else if (name == "swap/total") {
+            current.swap_size = value;
+        } else if (name == "swap/used") {
+            current.swap_used = value;
+        } else if (name == "swap/free") {
+            current.swap_free = value;
+        } else if (name == "vm/pageins") {
+            delta.pageins = value;
+        } else if (name == "vm/pageouts") {
+            delta.pageouts = value;
+        } else if (name == "vm/swapins") {
+            delta.swapins = value;
+        } else if (name == "vm/swapouts") {
+            delta.swapouts = value;
+        }
+    }
+    last = current;
+}
+
+uint16_t Memory::rows() const {
+    return options.condenseMemory ? 2 : 3;
+}
+
+uint16_t Memory::virtualMemoryRows() const {
+    return options.condenseVirtualMemory ? 1 : 3;
 }
 
 uint16_t Memory::print(bool newline) const {
@@ -112,7 +175,7 @@ uint16_t Memory::print(bool newline) const {
                     console.humanSize(this->page_size * (this->current.external_page_count + this->current.purgeable_count)), cached);
 #endif
     uint64_t cached = page_size * (current.external_page_count + current.purgeable_count);
-    double pct = (double(current.memory_used) - double(cached)) / double(current.memory_size);
+    double pct = current.memory_size ? (double(current.memory_used) - double(cached)) / double(current.memory_size) : 0;
     console.print("  %-12s %'9lld %'9lld %'9lld %'9lld %'9lld ",
                   "Real",
                   current.memory_size / 1024 / 1024,
@@ -126,6 +189,7 @@ uint16_t Memory::print(bool newline) const {
     if (!options.condenseMemory) {
         console.println("  %-12s %'9lld %'9lld %'9lld", "Swap", this->current.swap_size / 1024 / 1024,
                         this->current.swap_used / 1024 / 1024, this->current.swap_free / 1024 / 1024);
+        count++;
     }
     if (newline) {
         console.newline();
@@ -137,18 +201,28 @@ uint16_t Memory::print(bool newline) const {
 uint16_t Memory::printVirtualMemory(bool newline) {
     uint16_t count = 0;
 
-    console.inverseln("  %-16s %19s %22s", "[V]IRTUAL MEMORY", "  IN Current OUT  ", "  IN Aggregate OUT ");
+    console.inverseln("  %-16s %19s %22s", "[V]IRTUAL MEMORY", "  IN Per Sec OUT  ", "  IN Aggregate OUT ");
     count++;
-    if (!options.condenseVirtualMemory) {
+    if (!options.condenseVirtualMemory && loaded) {
+        // a recording has the rates but not the kernel's running totals
+        console.println("  %-12s %'9lld   %'9lld %9s     %9s", "Page",
+                        (long long) interval.per_second(double(this->delta.pageins)),
+                        (long long) interval.per_second(double(this->delta.pageouts)), "-", "-");
+        count++;
+        console.println("  %-12s %'9lld   %'9lld %9s     %9s", "Swap",
+                        (long long) interval.per_second(double(this->delta.swapins)),
+                        (long long) interval.per_second(double(this->delta.swapouts)), "-", "-");
+        count++;
+    } else if (!options.condenseVirtualMemory) {
         console.println("  %-12s %'9lld   %'9lld %'9lld     %'9lld", "Page",
-                        this->delta.pageins / 1024 / 1024,
-                        this->delta.pageouts / 1024 / 1024,
+                        (long long) interval.per_second(double(this->delta.pageins)),
+                        (long long) interval.per_second(double(this->delta.pageouts)),
                         this->current.pageins / 1024 / 1024,
                         this->current.pageouts / 10924 / 1024);
         count++;
         console.println("  %-12s %'9lld   %'9lld %'9lld     %'9lld", "Swap",
-                        this->delta.swapins / 1024 / 1024,
-                        this->delta.swapouts / 1024 / 1024,
+                        (long long) interval.per_second(double(this->delta.swapins)),
+                        (long long) interval.per_second(double(this->delta.swapouts)),
                         this->current.swapins / 1024 / 1024,
                         this->current.swapouts / 10924 / 1024);
         count++;
@@ -52,7 +52,9 @@ struct MemoryStats {
 class Memory {
 public:
     MemoryStats last, current, delta;
+    Interval interval; // between the last two reads
     uint64_t page_size;
+    bool loaded{false}; // showing load()'s frames, which have rates but no counters
 
 public:
     Memory();
@@ -66,7 +68,15 @@ public:
     // print memory stats unless test is set
     uint16_t print(bool newline) const;
 
+    // rows print() and printVirtualMemory() take
+    uint16_t rows() const;
+
+    uint16_t virtualMemoryRows() const;
+
     uint16_t printVirtualMemory(bool newline);
+
+    // replay: show the reader's last frame instead of what update() read
+    void load(const RecordingReader &reader);
 };
 
 extern Memory memory;
@@ -26,6 +26,7 @@
  * To exit, hit ^C.
  */
 #include "../cctop.h"
+#include <cmath>
 #include <mach/mach_host.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -38,6 +39,11 @@
 #include <csignal>
 //#include <unistd.h>
 
+// tunnels, AirDrop and loopback; their traffic is counted elsewhere or is local
+static bool hidden(const char *name) {
+    return !strncmp(name, "utun", 4) || !strncmp(name, "awdl", 4) || !strncmp(name, "lo", 2);
+}
+
 void Interface::diff(Interface *newer, Interface *older) {
     this->packetsIn = newer->packetsIn - older->packetsIn;
     this->packetsOut = newer->packetsOut - older->packetsOut;
@@ -45,7 +51,7 @@ void Interface::diff(Interface *newer, Interface *older) {
     this->bytesOut = newer->bytesOut - older->bytesOut;
 }
 
-void Network::read(std::map<std::string, Interface *> &m) {
+void Network::read() {
     int mib[] = {CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, 0};
     size_t len;
     if (sysctl(mib, 6, nullptr, &len, nullptr, 0) < 0) {
@@ -72,13 +78,8 @@ void Network::read(std::map<std::string, Interface *> &m) {
             char n[32];
             strncpy(n, sdl->sdl_data, sdl->sdl_nlen);
             n[sdl->sdl_nlen] = '\0';
-            std::string name(n);
 
-            Interface *iface = m[name];
-            if (!iface) {
-                iface = m[name] = new Interface;
-                iface->name = strdup(name.c_str());
-            }
+            Interface *iface = interfaces.sample(n);
 
             auto *data = &if2m->ifm_data;
             memcpy(iface->mac, &sdl->sdl_data[sdl->sdl_nlen], 6);
@@ -95,41 +96,72 @@ void Network::read(std::map<std::string, Interface *> &m) {
 }
 
 Network::Network() {
-    this->read(this->current);
-    this->copy(this->last, this->current);
-    this->copy(this->delta, this->current);
     this->update();
 }
 
-void Network::copy(std::map<std::string, Interface *> &dst, std::map<std::string, Interface *> &src) {
-    for (const auto &kv: src) {
-        auto *s = (Interface *) kv.second;
-        Interface *d = dst[s->name];
-        if (!d) {
-            d = dst[s->name] = new Interface;
-            d->name = strdup(s->name.c_str());
+void Network::update() {
+    interfaces.begin();
+    this->read();
+    interfaces.end();
+    uint64_t rx = 0, tx = 0;
+    interfaces.each([&](Device<Interface> &d) {
+        history().series("net/" + d.name + "/rx")->append(float(per_second(d.delta.bytesIn)));
+        history().series("net/" + d.name + "/tx")->append(float(per_second(d.delta.bytesOut)));
+        history().series("net/" + d.name + "/rx_packets")->append(float(per_second(d.delta.packetsIn)));
+        history().series("net/" + d.name + "/tx_packets")->append(float(per_second(d.delta.packetsOut)));
+        if (!hidden(d.name.c_str())) {
+            rx += d.delta.bytesIn;
+            tx += d.delta.bytesOut;
         }
-        d->type = s->type;
-        d->flags = s->flags;
-        memcpy(d->mac, s->mac, 6);
-        d->speed = s->speed;
-        d->packetsIn = s->packetsIn;
-        d->packetsOut = s->packetsOut;
-        d->bytesIn = s->bytesIn;
-        d->bytesOut = s->bytesOut;
+    });
+    // totals over the interfaces the panel shows
+    history().series("net/rx")->append(float(per_second(rx)));
+    history().series("net/tx")->append(float(per_second(tx)));
+}
+
+void Network::load(const RecordingReader &reader) {
+    std::map<std::string, Interface> recorded;
+    reader.each_device("net", [&](const std::string &name, const char *measurement, float value) {
+        Interface &i = recorded[name];
+        uint64_t rate = std::isnan(value) ? 0 : uint64_t(value);
+        if (!strcmp(measurement, "rx")) {
+            i.bytesIn = rate;
+        } else if (!strcmp(measurement, "tx")) {
+            i.bytesOut = rate;
+        } else if (!strcmp(measurement, "rx_packets")) {
+            i.packetsIn = rate;
+        } else if (!strcmp(measurement, "tx_packets")) {
+            i.packetsOut = rate;
+        }
+    });
+    loaded = true;
+    interfaces.begin();
+    for (auto &it: recorded) {
+        // recorded, so it was up and counting
+        it.second.flags = IFF_UP;
+        *interfaces.sample(it.first) = it.second;
     }
+    interfaces.end();
+    // the recorded figures are already per second
+    interfaces.interval.unit();
+    interfaces.each([](Device<Interface> &d) { d.delta = d.current; });
 }
 
-void Network::update() {
-    this->copy(this->last, this->current);
-    this->read(this->current);
-
-    for (auto &kv: this->delta) {
-        auto *i = (Interface *) kv.second;
-        Interface *newer = this->current[i->name],
-                *older = this->last[i->name];
-        i->diff(newer, older);
+// up and has ever received anything; every recorded one was
+static bool shown(const Device<Interface> &d, bool loaded) {
+    return !hidden(d.name.c_str()) && (loaded || (d.current.flags & IFF_UP && d.current.packetsIn));
+}
+
+uint16_t Network::rows() {
+    uint16_t count = 1;
+    if (!options.condenseNetwork) {
+        interfaces.each([&](Device<Interface> &d) {
+            if (shown(d, loaded)) {
+                count++;
+            }
+        });
     }
+    return count;
 }
 
 uint16_t Network::print(bool newline) {
@@ -138,40 +170,45 @@ uint16_t Network::print(bool newline) {
         console.inverseln("  %-10s %13s %13s", "[N]ETWORK", "Read (B/s)", "Write (B/s)", "RX Packets");
     } else {
         console.inverseln("  %-10s %13s %13s %13s %13s %13s %13s", "[N]ETWORK", "Read (B/s)", "Write (B/s)",
-                          "RX Packets",
-                          "TX Packets", "Total RX", "Total TX");
+                          "RX Packets/s",
+                          "TX Packets/s", "Total RX", "Total TX");
     }
     count++;
 
     if (!options.condenseNetwork) {
-        for (const auto &kv: this->delta) {
-            auto *i = (Interface *) kv.second;
-            const char *name = i->name.c_str();
-            if (!strncmp(name, "utun", 4) || !strncmp(name, "awdl", 4) || !strncmp(name, "lo", 2)) {
-                continue;
-            }
-            auto *c = (Interface *) this->current[name];
-            if (i->flags & IFF_UP && this->current[i->name]->packetsIn) {
+        interfaces.each([&](Device<Interface> &d) {
+            const char *name = d.name.c_str();
+            Interface *i = &d.delta, *c = &d.current;
+            if (shown(d, loaded)) {
+                bool alert = alerts.active() && alerts.firing("net/" + d.name + "/");
+                console.write("  ");
+                if (alert) {
+                    console.mode_inverse();
+                    console.mode_bold();
+                }
+                console.write(Text(name, -10, 0));
+                if (alert) {
+                    console.mode_inverse(false);
+                }
                 if (console.width < 98) {
-                    console.println("  %-10s %'13lld %'13lld",
-                                    i->name.c_str(),
-                                    i->bytesIn,
-                                    i->bytesOut
-                    );
+                    console.writeln(' ', Grouped(int64_t(per_second(i->bytesIn)), 13),
+                                    ' ', Grouped(int64_t(per_second(i->bytesOut)), 13));
                 } else {
-                    console.println("  %-10s %'13lld %'13lld %'13lld %'13lld %'13lld %'13lld",
-                                    i->name.c_str(),
-                                    i->bytesIn,
-                                    i->bytesOut,
-                                    i->packetsIn,
-                                    i->packetsOut,
-                                    c->packetsIn,
-                                    c->packetsOut
-                    );
+                    console.write(' ', Grouped(int64_t(per_second(i->bytesIn)), 13),
+                                  ' ', Grouped(int64_t(per_second(i->bytesOut)), 13),
+                                  ' ', Grouped(int64_t(per_second(i->packetsIn)), 13),
+                                  ' ', Grouped(int64_t(per_second(i->packetsOut)), 13));
+                    if (loaded) {
+                        // the kernel's totals aren't recorded
+                        console.writeln(' ', Text("-", 13), ' ', Text("-", 13));
+                    } else {
+                        console.writeln(' ', Grouped(c->packetsIn, 13), ' ', Grouped(c->packetsOut, 13));
+                    }
                 }
+                console.mode_clear();
                 count++;
             }
-        }
+        });
     }
     if (newline) {
         console.newline();
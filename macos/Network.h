@@ -26,11 +26,10 @@
 #ifndef C_NETWORK_H
 #define C_NETWORK_H
 
-#include <map>
+#include "../lib/DeviceTable.h"
 #include <string>
 
 struct Interface {
-  std::string name; // interface name (e.g. en0)
   int flags;
   u_char type;
   uint8_t mac[6]; // mac address
@@ -46,22 +45,28 @@ public:
 
 class Network {
 private:
-  std::map<std::string, Interface *> last, current, delta;
+  DeviceTable<Interface> interfaces; // by interface name (e.g. en0)
+  bool loaded{false};                // showing load()'s frames, which have rates but no totals or flags
 
 public:
   Network();
 
 protected:
-  void read(std::map<std::string, Interface *> &m);
+  void read();
 
-  static void copy(std::map<std::string, Interface *> &src,
-            std::map<std::string, Interface *> &dst);
+  double per_second(uint64_t delta) const { return interfaces.interval.per_second(double(delta)); }
 
 public:
   void update();
 
+  // header plus a row per interface that's up and shown, unless condensed
+  uint16_t rows();
+
   // print network stats, unless test is set,  return # lines (would be) printed
   uint16_t print(bool newline);
+
+  // replay: show the reader's last frame instead of what update() read
+  void load(const RecordingReader &reader);
 };
 
 extern Network network;
@@ -226,6 +226,7 @@ uint16_t Platform::print(bool newline) {
     }
     console.clear_eol();
     console.newline();
+    count++;
 
     if (newline) {
         console.newline();
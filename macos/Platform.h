@@ -65,6 +65,9 @@ public:
 public:
     void update();
 
+    // header, uptime/load and power lines
+    uint16_t rows() const { return 3; }
+
     uint16_t print(bool newline);
 };
 
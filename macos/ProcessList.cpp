@@ -4,6 +4,7 @@
 
 #include "../cctop.h"
 #include <libproc.h>
+#include <mach/mach_time.h>
 #include <vector>
 #include <utility>
 
@@ -18,12 +19,51 @@ ProcessList::~ProcessList() {
 
 static pid_t pids[99999];
 
+// mach absolute time units (task and rusage times) to nanoseconds; they're
+// only the same thing on Intel
+static uint64_t mach_ns(uint64_t t) {
+    static mach_timebase_info_data_t timebase{0, 0};
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return t * timebase.numer / timebase.denom;
+}
+
+// Scheduling delay and context switches for a process.  Linux kernels with
+// /proc/[pid]/schedstat give us both directly.  Otherwise fall back to
+// rusage's runnable time (mach absolute time units) and the task's total
+// context switch count, which has no voluntary/involuntary split.
+static void read_sched(pid_t pid, const proc_taskinfo &info, ProcessSchedStats *sched) {
+    if (SchedStat::has_process_stats() && SchedStat::read_process(pid, sched)) {
+        return;
+    }
+    rusage_info_v4 ri{};
+    if (proc_pid_rusage(pid, RUSAGE_INFO_V4, (rusage_info_t *) &ri) == 0) {
+        sched->wait_ns = int64_t(mach_ns(ri.ri_runnable_time));
+    }
+    sched->voluntary_csw = info.pti_csw;
+}
+
 void ProcessList::update() {
     touched++; // bump so we know which in list<> we've seen.
+    interval.stamp();
 
     int num_processes = proc_listallpids(pids, sizeof(pids));
     for (int pp = 0; pp < num_processes; pp++) {
         pid_t pid = pids[pp];
+        // filtered out processes aren't touched, so they drop out of list below
+        if (!filter.pid_ok(pid)) {
+            continue;
+        }
+        proc_bsdinfo proc{};
+        if (proc_pidinfo(pid, PROC_PIDTBSDINFO, 0, &proc, sizeof(proc)) == 0) {
+            continue;
+        }
+        uint32_t name_id = names.intern(proc.pbi_name[0] ? proc.pbi_name : proc.pbi_comm);
+        if (filter.active() && (!filter.match(names, name_id, proc.pbi_ruid) || !filter.cgroup_ok(pid))) {
+            continue;
+        }
+
         Process *p;
         bool isNew = false;
         if (list.count(pid) == 0) {
@@ -34,13 +74,7 @@ void ProcessList::update() {
         } else {
             p = list[pid];
         }
-
-        proc_bsdinfo proc{};
-        int ret = proc_pidinfo(pid, PROC_PIDTBSDINFO, 0, &proc, sizeof(proc));
-        if (ret == 0) {
-            list.erase(pid);
-            continue;
-        }
+        p->name_id = name_id;
         p->flags = proc.pbi_flags;
         p->status = proc.pbi_status;
         p->exit_status = proc.pbi_xstatus;
@@ -67,22 +101,27 @@ void ProcessList::update() {
         proc_pidinfo(pid, PROC_PIDTASKINFO, 0, &info, sizeof(info));
         p->virtual_size = info.pti_virtual_size;
         p->resident_size = info.pti_resident_size;
+        uint64_t total_system = mach_ns(info.pti_total_system), total_user = mach_ns(info.pti_total_user);
         if (isNew) {
             p->delta_system = 0;
             p->delta_user = 0;
         } else {
-            p->delta_system = info.pti_total_system - p->total_system;
-            p->delta_user = info.pti_total_user - p->total_user;
+            p->delta_system = total_system - p->total_system;
+            p->delta_user = total_user - p->total_user;
         }
         p->touched = touched;
         p->delta_cpu = p->delta_system + p->delta_user;
-        if (processor.total_ticks > 0) {
-            p->pct_cpu = double(p->delta_cpu) / double(processor.total_ticks);
-        } else {
-            p->pct_cpu = 0.;
+        // CPU seconds per second, so 1.0 is one whole core
+        p->pct_cpu = interval.per_second(double(p->delta_cpu)) / 1e9;
+        if (isNew) {
+            // a reused pid starts a new history
+            std::string name = "process/" + std::to_string(pid) + "/cpu";
+            history().remove(name);
+            p->cpu_history = history().series(name, PROCESS_HISTORY_DEPTH);
         }
-        p->total_user = info.pti_total_user;
-        p->total_system = info.pti_total_system;
+        p->cpu_history->append(float(p->pct_cpu * 100));
+        p->total_user = total_user;
+        p->total_system = total_system;
         p->threads_user = info.pti_threads_user;
         p->threads_system = info.pti_threads_system;
         p->policy = info.pti_policy;
@@ -98,6 +137,28 @@ void ProcessList::update() {
         p->numrunning = info.pti_numrunning;
         p->priority = info.pti_priority;
 
+        ProcessSchedStats sched;
+        read_sched(pid, info, &sched);
+        // a read that failed this time (-1) keeps the last total, so it counts as no change
+        // rather than a drop to 0 and a wrapped delta when it comes back
+        uint64_t wait_ns = sched.wait_ns < 0 ? p->total_wait_ns : uint64_t(sched.wait_ns);
+        int64_t voluntary = sched.voluntary_csw < 0 ? p->total_voluntary_csw : sched.voluntary_csw,
+                involuntary = sched.involuntary_csw < 0 ? p->total_involuntary_csw : sched.involuntary_csw;
+        if (isNew) {
+            p->delta_wait_ns = 0;
+            p->delta_voluntary_csw = p->delta_involuntary_csw = 0;
+        } else {
+            p->delta_wait_ns = wait_ns > p->total_wait_ns ? wait_ns - p->total_wait_ns : 0;
+            p->delta_voluntary_csw = p->total_voluntary_csw >= 0 && voluntary > p->total_voluntary_csw
+                                     ? uint64_t(voluntary - p->total_voluntary_csw) : 0;
+            p->delta_involuntary_csw = p->total_involuntary_csw >= 0 && involuntary > p->total_involuntary_csw
+                                       ? uint64_t(involuntary - p->total_involuntary_csw) : 0;
+        }
+        p->delta_csw = p->delta_voluntary_csw + p->delta_involuntary_csw;
+        p->total_wait_ns = wait_ns;
+        p->total_voluntary_csw = voluntary;
+        p->total_involuntary_csw = involuntary;
+
 #if 0
         if (uids.count(proc.pbi_uid) == 0) {
             passwd *pass = getpwuid(proc.pbi_uid);
@@ -109,65 +170,188 @@ void ProcessList::update() {
         }
 #endif
     }
+    // processes we didn't touch this pass have exited
+    for (auto it = list.begin(); it != list.end();) {
+        if (it->second->touched != touched) {
+            delete it->second;
+            it = list.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    sweep_names();
+}
+
+// every process left in list interned its name this pass
+void ProcessList::sweep_names() {
+    if (!names.sweep()) {
+        return;
+    }
+    for (auto &it: list) {
+        it.second->name_id = names.moved(it.second->name_id);
+    }
+    filter.renamed();
 }
 
+// ties go by pid, so equal processes don't trade places from one sort to the next
 static bool cmp(Process *a, Process *b) {
-    return a->pct_cpu > b->pct_cpu;
+    return a->pct_cpu != b->pct_cpu ? a->pct_cpu > b->pct_cpu : a->pid < b->pid;
 }
 
-uint16_t ProcessList::print(bool newline) {
-    uint16_t count = 0;
-    std::vector<Process *> sorted, to_remove;
-    // Loop through our map of processes (pid is key, value is struct).
-    //
-    // If the process' touched value is not up-to-date with the master one
-    // in processList, then it's no longer running and needs to be removed;
-    // we add it to the to_remove vector.
-    //
-    // Otherwise, we add it to the sorted vector.
-    //
-    int remove_count = 0;
+static bool cmp_delay(Process *a, Process *b) {
+    return a->delta_wait_ns != b->delta_wait_ns ? a->delta_wait_ns > b->delta_wait_ns : a->pid < b->pid;
+}
+
+static bool cmp_csw(Process *a, Process *b) {
+    if (a->delta_involuntary_csw != b->delta_involuntary_csw) {
+        return a->delta_involuntary_csw > b->delta_involuntary_csw;
+    }
+    return a->delta_csw != b->delta_csw ? a->delta_csw > b->delta_csw : a->pid < b->pid;
+}
+
+uint16_t ProcessList::rows() const {
+    return uint16_t(std::min(options.condenseProcesses ? 1 : list.size(), size_t(UINT16_MAX - 2)) + 2);
+}
+
+void ProcessList::sort() {
+    if (sorted_touched == touched && sorted_by == options.sortProcesses && sorted_filter == filter.text) {
+        return;
+    }
+    sorted.clear();
+    sorted.reserve(list.size());
     for (auto &it: list) {
-        auto p = it.second;
-        if (p->touched != touched) {
-            to_remove.push_back(p);
-            remove_count++;
-        } else {
-            sorted.push_back(p);
+        // a narrower filter shows at once; what a wider one lets back in
+        // (and cgroup terms) wait for the next update
+        Process *p = it.second;
+        if (filter.active() && (!filter.pid_ok(int(p->pid)) || !filter.match(names, p->name_id, p->ruid))) {
+            continue;
         }
+        sorted.push_back(p);
     }
-    // We now have two vectors - sorted (to be sorted) and to_remove (to be removed).
-    // Loop through to_remove and remove the Process structs from list.
-    for (auto &it: to_remove) {
-        auto p = it;
-        list.erase(p->pid);
+    switch (options.sortProcesses) {
+        case Options::SORT_DELAY:
+            std::sort(sorted.begin(), sorted.end(), cmp_delay);
+            break;
+        case Options::SORT_CSW:
+            std::sort(sorted.begin(), sorted.end(), cmp_csw);
+            break;
+        case Options::SORT_CPU:
+        default:
+            std::sort(sorted.begin(), sorted.end(), cmp);
+            break;
     }
+    sorted_touched = touched;
+    sorted_by = options.sortProcesses;
+    sorted_filter = filter.text;
+}
+
+void ProcessList::scroll_selection(int by) {
+    selecting = true;
+    moves += by;
+}
+
+void ProcessList::unselect() {
+    selecting = false;
+    selected = -1;
+    moves = 0;
+    first = 0;
+}
 
-    // sort away
-    std::sort(sorted.begin(), sorted.end(), cmp);
-    int printed = 0;
-    console.inverseln(" %6.6s %6.6s %-16.16s %-32.32s", "[P]ID", "CPU%", "USER", "NAME");
+void ProcessList::place(size_t rows) {
+    size_t n = sorted.size();
+    if (!selecting || n == 0) {
+        first = 0;
+        return;
+    }
+    // find the selected process wherever the sort put it and keep it on the
+    // same screen row; if it exited, whatever took its place is selected
+    size_t index;
+    if (selected < 0) {
+        // the first key selects the top row
+        index = first;
+        moves = 0;
+    } else {
+        size_t offset = selected_row - first;
+        index = std::min(selected_row, n - 1);
+        for (size_t i = 0; i < n; i++) {
+            if (int(sorted[i]->pid) == selected) {
+                index = i;
+                break;
+            }
+        }
+        first = index >= offset ? index - offset : 0;
+    }
+    int64_t moved = int64_t(index) + moves;
+    index = size_t(std::max(int64_t(0), std::min(moved, int64_t(n) - 1)));
+    moves = 0;
+
+    // scroll only as far as it takes to show it
+    if (index < first) {
+        first = index;
+    } else if (index >= first + rows) {
+        first = index - rows + 1;
+    }
+    first = std::min(first, n > rows ? n - rows : 0);
+    selected = int(sorted[index]->pid);
+    selected_row = index;
+}
+
+uint16_t ProcessList::print(bool newline) {
+    uint16_t count = 0;
+    // once per update, or when the order changes; redraws reuse it
+    sort();
+
+    // mark the sort column
+    int sort = options.sortProcesses;
+    console.inverseln(" %6.6s %6.6s %9.9s %7.7s %7.7s %-16.16s %-32.32s", "[P]ID",
+                      sort == Options::SORT_CPU ? "*CPU%" : "CPU%",
+                      sort == Options::SORT_DELAY ? "*DLY ms/s" : "DLY ms/s",
+                      "CSW/s",
+                      sort == Options::SORT_CSW ? "*ICSW/s" : "ICSW/s",
+                      "USER", "NAME");
     count++;
-    int lines = console.height - console.cursor_row() -2;
-    for (auto &it: sorted) {
-        auto p = it;
-//        if (p->ppid > 1) continue;
-        printed++;
-        auto pass = username(p->ruid);
-        auto grp = groupname(p->rgid);
 
+    // whatever the viewport has left after the count line (and the blank line)
+    int lines = console.height - console.cursor_row() - 1 - (newline ? 1 : 0);
+    page = uint16_t(std::max(options.condenseProcesses ? 1 : lines, 1));
+    place(page);
+
+    // only the rows that are showing get formatted (or their user looked up)
+    size_t last = std::min(sorted.size(), first + page);
+    for (size_t i = first; i < last; i++) {
+        Process *p = sorted[i];
+        if (selecting && int(p->pid) == selected) {
+            console.mode_inverse(true);
+        }
         if (!strcmp(p->name, "cctop")) {
             console.mode_bold(true);
         }
-        console.println(" %6d %6.1f %-16.16s %-32.32s", p->pid, p->pct_cpu * 1000, pass, p->name);
-        console.mode_bold(false);
-        count++;
-        if (options.condenseProcesses) {
-            break;
+        console.write(' ', Number(p->pid, 6),
+                      ' ', Fixed(p->pct_cpu * 100, 6, 1),
+                      ' ', Fixed(interval.per_second(double(p->delta_wait_ns)) / 1e6, 9, 1),
+                      ' ', Number(int64_t(interval.per_second(double(p->delta_csw))), 7), ' ');
+        if (p->total_involuntary_csw >= 0) {
+            console.write(Number(int64_t(interval.per_second(double(p->delta_involuntary_csw))), 7));
+        } else {
+            console.write(Text("-", 7));
         }
-        if (printed > lines) break;
+        console.write(' ', Text(username(p->ruid), -16), ' ', Text(p->name, -32));
+        console.mode_clear();
+        console.newline();
+        count++;
     }
-    console.println("  %ld processes", sorted.size());
+    console.print("  %zu processes", sorted.size());
+    if (first > 0 || last < sorted.size()) {
+        console.print(", %zu-%zu shown", first + 1, last);
+    }
+    if (filter.editing) {
+        console.mode_bold(true);
+        console.print("  Filter: %s_", filter.text.c_str());
+        console.mode_clear();
+    } else if (filter.active()) {
+        console.print(" matching \"%s\" (/ to change)", filter.text.c_str());
+    }
+    console.newline();
     count++;
     if (newline) {
         console.newline();
@@ -176,4 +360,70 @@ uint16_t ProcessList::print(bool newline) {
     return count;
 }
 
+RecordedProcess ProcessList::shown(const Process *p) const {
+    RecordedProcess r;
+    r.pid = p->pid;
+    r.ruid = p->ruid;
+    r.cpu = int32_t(std::lround(p->pct_cpu * 1000));
+    r.delay = int32_t(std::lround(interval.per_second(double(p->delta_wait_ns)) / 1e5));
+    r.csw = int32_t(interval.per_second(double(p->delta_csw)));
+    r.icsw = p->total_involuntary_csw >= 0 ? int32_t(interval.per_second(double(p->delta_involuntary_csw))) : -1;
+    return r;
+}
+
+void ProcessList::record(RecordingWriter &writer) const {
+    for (const auto &it: list) {
+        const Process *p = it.second;
+        writer.process(shown(p), p->name[0] ? p->name : p->comm);
+    }
+}
+
+void ProcessList::busiest(size_t n, std::vector<std::pair<RecordedProcess, const char *>> &out) {
+    busy.clear();
+    for (const auto &it: list) {
+        busy.push_back(it.second);
+    }
+    n = std::min(n, busy.size());
+    std::partial_sort(busy.begin(), busy.begin() + long(n), busy.end(), cmp);
+    out.clear();
+    for (size_t i = 0; i < n; i++) {
+        out.emplace_back(shown(busy[i]), busy[i]->name[0] ? busy[i]->name : busy[i]->comm);
+    }
+}
+
+void ProcessList::load(const RecordingReader &reader) {
+    touched++;
+    // the recorded figures are already per second
+    interval.unit();
+    for (const auto &it: reader.processes) {
+        const RecordedProcess &r = it.second;
+        Process *&p = list[int(r.pid)];
+        if (!p) {
+            p = new Process();
+        }
+        p->pid = r.pid;
+        p->ruid = r.ruid;
+        const std::string &name = reader.names[r.name];
+        snprintf(p->name, sizeof(p->name), "%s", name.c_str());
+        p->name_id = names.intern(name.c_str());
+        p->pct_cpu = double(r.cpu) / 1000;
+        p->delta_wait_ns = uint64_t(std::max(r.delay, 0)) * 100000;
+        p->delta_involuntary_csw = uint64_t(std::max(r.icsw, 0));
+        p->total_involuntary_csw = r.icsw;
+        p->delta_csw = uint64_t(std::max(r.csw, 0));
+        // recorded processes have no history of their own
+        p->cpu_history = nullptr;
+        p->touched = touched;
+    }
+    for (auto it = list.begin(); it != list.end();) {
+        if (it->second->touched != touched) {
+            delete it->second;
+            it = list.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    sweep_names();
+}
+
 ProcessList processList;
\ No newline at end of file
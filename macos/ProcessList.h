@@ -9,12 +9,21 @@
 // of ordering...
 #include <unordered_map>
 
+#include "../lib/Clock.h"
+#include "../lib/History.h"
+#include "../lib/Recording.h"
+#include "../common/ProcessFilter.h"
 #include <string>
 #include <string.h>
+#include <vector>
 #include <sys/mount.h>
 #include <pwd.h>
 #include <grp.h>
 
+// samples of % CPU kept per process, a few minutes' worth; there's one series
+// for every live process, so they don't get the machine-wide series' depth
+const uint32_t PROCESS_HISTORY_DEPTH = 300;
+
 struct Process {
     uint32_t pid{};
     uint64_t delta_cpu{};
@@ -32,6 +41,7 @@ struct Process {
     gid_t svgid{};
     char comm[MAXCOMLEN + 1]{};
     char name[2 * MAXCOMLEN + 1]{};
+    uint32_t name_id{};           /* in ProcessList::names */
     uint32_t nfiles{};
     uint32_t pgid{};
     uint32_t pjobc{};
@@ -60,6 +70,19 @@ struct Process {
     int32_t threadnum{};          /* number of threads in the task */
     int32_t numrunning{};         /* number of running threads */
     int32_t priority{};           /* task priority*/
+
+    // scheduling delay: time runnable but waiting for a CPU
+    uint64_t total_wait_ns{};
+    uint64_t delta_wait_ns{};
+    // context switches during the last interval; the voluntary/involuntary
+    // split is only known where the kernel reports it (-1 totals otherwise)
+    int64_t total_voluntary_csw{-1};
+    int64_t total_involuntary_csw{-1};
+    uint64_t delta_csw{};
+    uint64_t delta_voluntary_csw{};
+    uint64_t delta_involuntary_csw{};
+
+    Series *cpu_history{}; // % CPU per update, owned by history(); PROCESS_HISTORY_DEPTH deep
 };
 
 class ProcessList {
@@ -71,11 +94,66 @@ public:
 public:
     void update();
 
+    // header, every process and the count below them; print() shows as many
+    // as fit the rows it's given
+    uint16_t rows() const;
+
     uint16_t print(bool newline);
 
+    // Move the selection by this many rows; the first call selects the top
+    // row shown.  The selection follows its pid through re-sorts.
+    void scroll_selection(int by);
+
+    // back to following the top of the list
+    void unselect();
+
+    // applied in update(), so what it leaves out is never fully read
+    ProcessFilter filter;
+
+    // process rows shown last time, for paging
+    uint16_t rows_shown() const { return page; }
+
+    // add the processes to the frame being written
+    void record(RecordingWriter &writer) const;
+
+    // the n using the most CPU, as the list shows them, with their names
+    void busiest(size_t n, std::vector<std::pair<RecordedProcess, const char *>> &out);
+
+    // replay: show the reader's last frame instead of what update() read
+    void load(const RecordingReader &reader);
+
 protected:
     int64_t touched{0};
+    Interval interval; // between the last two updates
     std::unordered_map<int, Process *> list;
+    NamePool names;
+
+    // drop names no process has any more, moving name_ids to match
+    void sweep_names();
+
+    // list in display order, redone only when touched or the sort changes
+    std::vector<Process *> sorted;
+    int64_t sorted_touched{-1};
+    int sorted_by{-1};
+    std::string sorted_filter;
+
+    // scrolling: index of the first row shown, the selected pid (-1 for the
+    // first key) and the index it was at, and keys not yet applied
+    size_t first{0}, selected_row{0};
+    int selected{-1};
+    bool selecting{false};
+    int moves{0};
+    uint16_t page{1};
+
+    std::vector<Process *> busy; // for busiest()
+
+    void sort();
+
+    // what the list shows for p
+    RecordedProcess shown(const Process *p) const;
+
+    // resolve the selection against sorted and pick first for this many rows
+    void place(size_t rows);
 //    std::unordered_map<uid_t, std::string *> uids;
 //    std::unordered_map<gid_t, std::string *> gids;
 
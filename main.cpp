@@ -1,5 +1,6 @@
 #include "cctop.h"
 #include <clocale>
+#include <fcntl.h>
 #include <unistd.h>
 
 #pragma clang diagnostic push
@@ -14,75 +15,239 @@ void resize_help() {
 #endif
 }
 
-int required_lines = -1;
+// panels top to bottom; the layout decides where each one goes
+// the collectors' panels, as the local view has them; all hidden while shown() is false
+static void add_panels(const std::function<bool()> &shown) {
+    Pane &cpu = layout.add([shown] { return shown() ? processor.rows() : uint16_t(0); },
+                           [](bool newline) { return processor.print(newline); });
+    cpu.compact = &options.condenseCPU;
+    cpu.wanted = &options.condenseCPU_state;
+    layout.add([shown] { return shown() ? graphs.rows() : uint16_t(0); },
+               [](bool newline) { return graphs.print(newline); });
+    // every one of these works at MIN_WIDTH, so two of them fit side by side on a wide window
+    layout.add([shown] { return shown() ? memory.rows() : uint16_t(0); },
+               [](bool newline) { return memory.print(newline); })
+            .column_width = MIN_WIDTH;
+    layout.add([shown] { return shown() ? memory.virtualMemoryRows() : uint16_t(0); },
+               [](bool newline) { return memory.printVirtualMemory(newline); })
+            .column_width = MIN_WIDTH;
+    layout.add([shown] { return shown() ? disk.rows() : uint16_t(0); },
+               [](bool newline) { return disk.print(newline); })
+            .column_width = MIN_WIDTH;
+    layout.add([shown] { return shown() ? filesystem.rows() : uint16_t(0); },
+               [](bool newline) { return filesystem.print(newline); })
+            .column_width = MIN_WIDTH;
+    layout.add([shown] { return shown() ? network.rows() : uint16_t(0); },
+               [](bool newline) { return network.print(newline); })
+            .column_width = MIN_WIDTH;
+}
 
-uint16_t loop() {
-    if (console.width < MIN_WIDTH || console.height < MIN_HEIGHT) {
-//        debug.log("resize_help");
-        resize_help();
-        return 0;
+static void build_layout() {
+    if (options.fleet()) {
+        // the table, or one host the way -c shows a daemon
+        layout.add([] { return fleet.rows(); }, [](bool newline) { return fleet.print(newline); })
+                .elastic = 3;
+        layout.add([] { return fleet.host_rows(); }, [](bool newline) { return fleet.print_host(newline); });
+        add_panels([] { return fleet.drilled(); });
+        layout.add([] { return fleet.drilled() ? processList.rows() : uint16_t(0); },
+                   [](bool newline) { return processList.print(newline); })
+                .elastic = 3;
+        return;
+    }
+    if (options.replay || options.connect) {
+        // the recording (or the daemon) stands in for the collectors, its frames drawn through their panels
+        layout.add([] { return replay.rows(); }, [](bool newline) { return replay.print(newline); });
+        add_panels([] { return true; });
+        layout.add([] { return processList.rows(); }, [](bool newline) { return processList.print(newline); })
+                .elastic = 3;
+        return;
     }
-    int lines = 0;
+    layout.add([] { return platform.rows(); }, [](bool newline) { return platform.print(newline); });
+    layout.add([] { return alerts.rows(); }, [](bool newline) { return alerts.print(newline); });
+    add_panels([] { return true; });
+    layout.add([] { return interrupts.rows(); }, [](bool newline) { return interrupts.print(newline); })
+            .column_width = MIN_WIDTH;
+    // header, a process and the count
+    layout.add([] { return processList.rows(); }, [](bool newline) { return processList.print(newline); })
+            .elastic = 3;
+}
 
+// the last sample, flattened; taken only when something writes or serves it
+static Snapshot snapshot;
+
+// take one sample from every collector; only the tick calls this
+static void sample() {
+    history().begin();
     platform.update();
     processor.update();
+    sensors.update();
+    schedstat.update();
     memory.update();
     disk.update();
+    filesystem.update();
     network.update();
+    interrupts.update();
     processList.update();
-
-    console.moveTo(0, 0);
-    console.mode_clear();
-
-#ifndef USE_NCURSES
-    if (!options.showHelp) {
-#endif
-    bool condense = options.condenseMain;
-    options.condenseCPU = options.condenseCPU_state;
-    if (console.height < 40) {
-        options.condenseCPU = true;
-        if (console.height < 35) {
-            condense = true;
-        }
-    } else if (console.height < 45) {
-        condense = true;
-    }
-//    debug.log("window %d x %d %d\n", console.width, console.height, condense);
-    lines += platform.print(!condense);
-    lines += processor.print(!condense);
-    lines += memory.print(!condense);
-    lines += memory.printVirtualMemory(!condense);
-    lines += disk.print(!condense);
-    lines += network.print(!condense);
-    lines += processList.print(!condense);
-#ifndef USE_NCURSES
+    history().end();
+    if (options.headless() || metricsServer.listening() || pushExporter.running() || sharedPublisher.publishing() ||
+        viewerServer.listening() || alerts.active()) {
+        snapshot.take();
+        alerts.evaluate(snapshot);
+        metricsServer.publish(snapshot);
+        pushExporter.publish(snapshot);
     }
-#endif
+    if (sharedPublisher.publishing()) {
+        static SharedPublisher::Processes busiest;
+        processList.busiest(SHARED_MAX_PROCESSES, busiest);
+        sharedPublisher.publish(snapshot, busiest);
+    }
+    if (viewerServer.listening()) {
+        processList.record(viewerServer.begin(snapshot));
+        viewerServer.end();
+    }
+}
 
-    if (required_lines == -1) {
-        required_lines = lines;
+// draw the last sample; cheap enough to call on every key and resize
+uint16_t render() {
+    if (console.width < MIN_WIDTH || console.height < MIN_HEIGHT) {
+//        debug.log("resize_help");
+        resize_help();
+        return 0;
     }
+    layout.arrange(console.width, console.height, !options.condenseMain);
+    uint16_t lines = layout.print();
     Help::show();
-    lines++;
-//    console.print("%d/%d lines %dx%d\n", lines, required_lines, console.width, console.height);
-//    console.clear(true);
     return lines;
 }
 
-int main() {
+// redraw the last sample
+static void draw() {
+    render();
+    console.update();
+}
+
+static void tick() {
+    if (fleet.active()) {
+        fleet.tick();
+    } else if (replay.active()) {
+        replay.tick();
+    } else {
+        sample();
+    }
+    draw();
+}
+
+static void quit(const char *message) {
+    if (options.headless()) {
+        exit(0);
+    }
+    console.cleanup();
+    printf("%s", message);
+    exit(0);
+}
+
+// -f/-o/-r: sample on the same timer, but write records instead of drawing
+static void run_headless() {
+    static SnapshotWriter *writer = nullptr;
+    static RecordingWriter recording;
+    if (options.format != Options::FORMAT_NONE) {
+        int fd = STDOUT_FILENO;
+        if (options.output) {
+            fd = open(options.output, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                fprintf(stderr, "cctop: %s: %s\n", options.output, strerror(errno));
+                exit(1);
+            }
+        }
+        writer = new SnapshotWriter(fd, options.format == Options::FORMAT_CSV ? SnapshotWriter::CSV : SnapshotWriter::NDJSON);
+    }
+    if (options.record && !recording.open(options.record)) {
+        fprintf(stderr, "cctop: %s: %s\n", options.record, errno == EINVAL ? "not a recording" : strerror(errno));
+        exit(1);
+    }
+    static uint64_t written = 0;
+    auto record = [] {
+        sample();
+        if (writer && !writer->write(snapshot)) {
+            fprintf(stderr, "cctop: write: %s\n", strerror(errno));
+            exit(1);
+        }
+        if (options.record) {
+            recording.begin(snapshot);
+            processList.record(recording);
+            if (!recording.end()) {
+                fprintf(stderr, "cctop: %s: %s\n", options.record, strerror(errno));
+                exit(1);
+            }
+        }
+        if (options.count && ++written >= options.count) {
+            exit(0);
+        }
+    };
+    if (filesystem.changes_descriptor() >= 0) {
+        eventLoop.watch(filesystem.changes_descriptor(), EVENT_PRIORITY, [] { filesystem.changes_ready(); });
+    }
+    eventLoop.every(options.read_timeout, record);
+    record();
+    for (;;) {
+        eventLoop.wait();
+    }
+}
+
+int main(int ac, char *av[]) {
     setlocale(LC_ALL, "");
+    options.parse(ac, av);
+    history().set_depth(options.history_depth);
+    build_layout();
+    // before anything starts a thread, so they all inherit the blocked mask
+    eventLoop.on_signal(SIGINT, [] { quit("^C\n"); });
+    eventLoop.on_signal(SIGTERM, [] { quit("KILLED\n"); });
+    if (!options.headless()) {
+        eventLoop.on_signal(SIGWINCH, [] {
+            console.resized();
+            draw();
+        });
+    }
+    if (options.listen && !metricsServer.listen(options.listen)) {
+        console.abort("cctop: --listen %s: %s\n", options.listen, strerror(errno));
+    }
+    if (options.shm && !sharedPublisher.open(options.shm)) {
+        console.abort("cctop: --shm %s: %s\n", options.shm, strerror(errno));
+    }
+    if (options.daemon && !viewerServer.listen(options.daemon)) {
+        console.abort("cctop: --daemon %s: %s\n", options.daemon, strerror(errno));
+    }
+    std::string error;
+    if (options.push && !pushExporter.start(options.push, options.push_select, error)) {
+        console.abort("cctop: --push %s: %s\n", options.push, error.c_str());
+    }
+    if (options.alerts && !alerts.open(options.alerts, options.alert_log, options.alert_exec, error)) {
+        console.abort("cctop: --alerts %s\n", error.c_str());
+    }
+    if (options.headless()) {
+        run_headless();
+    }
+    if (options.replay) {
+        replay.open(options.replay);
+    }
+    if (options.fleet()) {
+        fleet.open(options.connect, draw);
+    } else if (options.connect) {
+        replay.connect(options.connect, draw);
+    }
+    console.start();
     console.clear();
     console.raw();
 
 #if __APPLE__
     uid_t uid = geteuid();
-    if (uid != 0) { // not root's UID
+    if (uid != 0 && !replay.active() && !fleet.active()) { // not root's UID
         console.moveTo(0,0);
         console.print("*** Warning: This program should be run as root, or via sudo!\n");
         console.print("    Otherwise, only your user processes can be examined.\n");
         console.print("    Do you wish to continue anyway? (y/N): ");
         int c;
-        if (!console.read_character(&c, false)) {
+        if (!console.read_character(&c)) {
             exit(0);
         }
         if (c == 'N' || c == 'n') {
@@ -135,17 +300,28 @@ int main() {
         printf("\n");
 #else
 
-    wchar_t b = L'■';
-    int c;
     console.raw(true);
     console.show_cursor(false);
-    loop();
-    for (;;) {
-        loop();
-        console.update();
-        if (console.read_character(&c, true)) {
+
+    eventLoop.watch(STDIN_FILENO, EVENT_READ, [] {
+        int c, keys = 0;
+        while (console.read_key(&c)) {
             options.process(c);
+            keys++;
         }
+        if (keys == 0) {
+            // readable with nothing to read: end of file
+            eventLoop.unwatch(STDIN_FILENO);
+        }
+        draw();
+    });
+    if (filesystem.changes_descriptor() >= 0) {
+        eventLoop.watch(filesystem.changes_descriptor(), EVENT_PRIORITY, [] { filesystem.changes_ready(); });
+    }
+    eventLoop.every(options.read_timeout, tick);
+    tick();
+    for (;;) {
+        eventLoop.wait();
     }
 #endif
     return 0;
@@ -0,0 +1,66 @@
+// Formatting throughput: the old vsprintf path (Console::println) against the
+// typed fields of lib/Format.h, both drawing a disk panel row into a Screen.
+//
+//   make && ./formatbench [rows]
+
+#include "../../lib/Format.h"
+#include "../../lib/Screen.h"
+#include <chrono>
+#include <clocale>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+static Screen screen;
+
+// what Console::println did for every row
+static void println(const char *fmt, ...) {
+    va_list ap;
+    char buffer[1024];
+
+    va_start(ap, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, ap);
+    va_end(ap);
+    screen.puts(buffer);
+    screen.newline();
+}
+
+template<typename... Fields>
+static void writeln(const Fields &... fields) {
+    (write_field(screen, fields), ...);
+    screen.newline();
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int ac, char *av[]) {
+    setlocale(LC_ALL, "");
+    long rows = ac > 1 ? atol(av[1]) : 2000000;
+    screen.resize(200, 60);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < rows; i++) {
+        if (i % 50 == 0) {
+            screen.move(0, 0);
+        }
+        println("  %-16s %'13ld %'13ld %'13ld %'13ld %6.1f%%", "disk0", 4096L, i * 4099, i * 17, i * 3, double(i % 1000) / 10);
+    }
+    double printf_time = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < rows; i++) {
+        if (i % 50 == 0) {
+            screen.move(0, 0);
+        }
+        writeln("  ", Text("disk0", -16, 0), ' ', Grouped(4096, 13), ' ', Grouped(i * 4099, 13), ' ',
+                Grouped(i * 17, 13), ' ', Grouped(i * 3, 13), ' ', Percent(double(i % 1000) / 10, 6, 1));
+    }
+    double typed_time = seconds(start);
+
+    printf("%ld rows\n", rows);
+    printf("  vsprintf    %7.1f ns/row\n", printf_time * 1e9 / double(rows));
+    printf("  Format.h    %7.1f ns/row  (%.1fx)\n", typed_time * 1e9 / double(rows), printf_time / typed_time);
+    return 0;
+}